@@ -1,5 +1,6 @@
 #include <vector>
 #include <sstream>
+#include <random>
 #include "gorilla.h"
 
 using namespace std;
@@ -24,6 +25,75 @@ void write_bit_test() {
     }
 }
 
+// Check that stream, internal buffer and caller-provided buffer modes write the same bytes
+// as a naive bit-by-bit reference, also when the caller-provided buffer is too small.
+void write_bits_modes_test() {
+    std::mt19937_64 gen(42);
+    std::vector<std::pair<uint64_t, int>> fields;
+    std::vector<bool> reference_bits;
+    for (int i = 0; i < 10000; i++) {
+        int nbits = static_cast<int>(gen() % 65);
+        uint64_t value = gen();
+        fields.emplace_back(value, nbits);
+        for (int b = nbits - 1; b >= 0; b--) {
+            reference_bits.push_back((value >> b) & 1);
+        }
+    }
+    while (reference_bits.size() % 8 != 0) {
+        reference_bits.push_back(true);
+    }
+    std::string expected(reference_bits.size() / 8, '\0');
+    for (size_t i = 0; i < reference_bits.size(); i++) {
+        if (reference_bits[i]) {
+            expected[i / 8] = static_cast<char>(expected[i / 8] | (0x80 >> (i % 8)));
+        }
+    }
+
+    stringstream ss;
+    std::vector<uint8_t> external(expected.size());
+    std::vector<uint8_t> short_external(expected.size() / 2);
+    {
+        BitWriter stream_bw(ss);
+        BitWriter buffer_bw;
+        BitWriter span_bw(external);
+        BitWriter short_span_bw(short_external);
+        for (auto [value, nbits] : fields) {
+            stream_bw.writeBits(value, nbits);
+            buffer_bw.writeBits(value, nbits);
+            span_bw.writeBits(value, nbits);
+            short_span_bw.writeBits(value, nbits);
+        }
+        stream_bw.flush(true);
+        buffer_bw.flush(true);
+        span_bw.flush(true);
+        short_span_bw.flush(true);
+
+        if (buffer_bw.bitSize() != reference_bits.size() || span_bw.size() != expected.size()) {
+            std::cerr << "write_bits_modes_test: Sizes differ." << std::endl;
+            return;
+        }
+        std::string buffer_str(reinterpret_cast<const char *>(buffer_bw.data()), buffer_bw.size());
+        if (buffer_str != expected) {
+            std::cerr << "write_bits_modes_test: Internal buffer mode output differs." << std::endl;
+            return;
+        }
+        std::string short_span_str(reinterpret_cast<const char *>(short_span_bw.data()), short_span_bw.size());
+        if (span_bw.overflowed() || !short_span_bw.overflowed() || short_span_str != expected) {
+            std::cerr << "write_bits_modes_test: Caller-provided buffer overflow is not handled." << std::endl;
+            return;
+        }
+    }
+    if (ss.str() != expected) {
+        std::cerr << "write_bits_modes_test: Stream mode output differs." << std::endl;
+        return;
+    }
+    if (std::string(external.begin(), external.end()) != expected) {
+        std::cerr << "write_bits_modes_test: Caller-provided buffer mode output differs." << std::endl;
+        return;
+    }
+}
+
 int main() {
     write_bit_test();
+    write_bits_modes_test();
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <bitset>
 #include <cmath>
 #include <cstdint>
@@ -20,170 +21,416 @@
 #include <vector>
 #include <bit>
 #include <optional>
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <array>
+#include <concepts>
+#include <limits>
+#include <tuple>
+#include <charconv>
+#include <string_view>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // ---------- COMPRESSION ------------------
+// Bits accumulated MSB-first in a 64-bit word, the packing shared by the bit writers. A full word
+// is passed to `emit_word` and the accumulator starts over.
+struct BitAccumulator {
+    // Pending bits, left-aligned (the next bit goes to position `63 - bits`).
+    uint64_t word = 0;
+    int bits = 0;
+
+    template<typename F>
+    void writeBit(bool bit, F &&emit_word) {
+        word |= static_cast<uint64_t>(bit) << (63 - bits);
+        bits++;
+        if (bits == 64) {
+            emit_word(word);
+            word = 0;
+            bits = 0;
+        }
+    }
+
+    // Append the `nbits` right-most bits of `u64` (see `BitWriter::writeBits`).
+    template<typename F>
+    void writeBits(uint64_t u64, int nbits, F &&emit_word) {
+        if (nbits == 0) {
+            return;
+        }
+        // Leave only `nbits` of meaningful bits.
+        if (nbits < 64) {
+            u64 &= (uint64_t(1) << nbits) - 1;
+        }
+
+        int free_bits = 64 - bits;
+        if (nbits < free_bits) {
+            //            writing ->
+            // word: [xxx****...*]
+            //  x -- non-empty (bits)
+            //  * -- empty     (free_bits)
+            word |= u64 << (free_bits - nbits);
+            bits += nbits;
+            return;
+        }
+        // The field crosses the word boundary: complete the current word with the leading
+        // part of `u64` and start a new one with the remaining (right-most) part.
+        int overflow_bits = nbits - free_bits;
+        word |= u64 >> overflow_bits;
+        emit_word(word);
+        word = overflow_bits > 0 ? u64 << (64 - overflow_bits) : 0;
+        bits = overflow_bits;
+    }
+};
+
+// Bits are accumulated MSB-first in a 64-bit word and emitted into a contiguous byte buffer
+// with a single big-endian store per word. The writer can be used in three modes:
+// * `BitWriter(std::ostream &)` -- completed bytes are passed to the stream at the end of every
+//   write call (one `write` per call instead of one per byte), so the stream content is the same
+//   as with the old per-byte writer at any point;
+// * `BitWriter()` -- bits are written into an internal growable buffer (see `data`/`size`);
+// * `BitWriter(std::span<uint8_t>)` -- bits are written into caller-provided memory. If it runs out,
+//   the writer carries on in the internal buffer and reports it with `overflowed`.
 class BitWriter {
 public:
-    explicit BitWriter(std::ostream &os) : out(os), buffer(0), count(8) {}
+    explicit BitWriter(std::ostream &os) : out_(&os) {}
+
+    BitWriter() = default;
+
+    explicit BitWriter(std::span<uint8_t> span) : external_(span.data()), capacity_(span.size()) {}
+
+    BitWriter(const BitWriter &) = delete;
+
+    BitWriter &operator=(const BitWriter &) = delete;
 
-    // Write a single bit at the available right-most position of the `buffer`.
+    // Write a single bit at the available right-most position of the accumulator.
     void writeBit(bool bit) {
-        if (bit) {
-            // 1. mask = 1 << (count - 1)
-            // Shift binary representation of 1 to the left by (count - 1) positions
-            // (create a mask with a single bit set at position (count - 1)).
-            //
-            // 2. buffer |= mask
-            // Apply bitwise OR assignment operator.
-            buffer |= (1 << (count - 1));
-        }
-        count--;
-
-        // If `buffer` is filled, write it out and reinitialize.
-        if (count == 0) {
-            writeBuf();
-            buffer = 0;
-            count = 8;
+        acc_.writeBit(bit, [this](uint64_t word) {
+            emitWord(word);
+        });
+        if (out_ != nullptr) {
+            syncStream();
         }
     }
 
-    // Write the `nbits` right-most bits of `u64` to the `buffer` in left-to-right order.
+    // Write the `nbits` right-most bits of `u64` to the stream in left-to-right order.
     //
     // E.g., given:
     // * `u64`   = ...0001010101010_000111
     // * `nbits` = 6,
-    // it will write `000111` to the buffer.
+    // it will write `000111` to the stream.
     void writeBits(uint64_t u64, int nbits) {
-        // Left-shit `u64` leaving only `nbits` of meaningful bits (on leading positions).
-        // Was:    ...0001010101010_000111
-        // Becase: 000111...00000000000000
-        u64 <<= (64 - nbits);
-        while (nbits >= 8) {
-            auto byte = static_cast<uint8_t>(u64 >> 56);
-            writeByte(byte);
-            u64 <<= 8;
-            nbits -= 8;
+        acc_.writeBits(u64, nbits, [this](uint64_t word) {
+            emitWord(word);
+        });
+        if (out_ != nullptr) {
+            syncStream();
         }
+    }
 
-        while (nbits > 0) {
-            bool bit = (u64 >> 63) == 1;
-            writeBit(bit);
+    // Write a single byte to the stream, regardless of alignment.
+    void writeByte(uint8_t byte) {
+        writeBits(byte, 8);
+    }
 
-            u64 <<= 1;
-            nbits--;
+    // Write bytes to the stream. Byte-aligned writes are done with a single copy.
+    void writeBytes(std::span<const uint8_t> bytes) {
+        if (acc_.bits % 8 != 0) {
+            for (uint8_t byte: bytes) {
+                writeByte(byte);
+            }
+            return;
+        }
+        emitCompletedBytes();
+        if (!bytes.empty()) {
+            std::memcpy(reserve(bytes.size()), bytes.data(), bytes.size());
+            size_ += bytes.size();
+        }
+        if (out_ != nullptr) {
+            syncStream();
         }
     }
 
-    // Write a single byte to the stream, regardless of alignment.
-    void writeByte(uint8_t byte) {
-        //            writing ->
-        // buffer:         [xxx*****]
-        //  x -- non-empty (3)
-        //  * -- empty     (5 = count)
-        // 1. Shift `byte` on the number of already taken positions of `buffer`
-        //    (3 in this example).
-        // Was:    11001100
-        // Became: 00011001
-        // 2. Write the mask to the `buffer`.
-        // 3. Write out the `buffer`.
-        // 4. Write the remaining (right-remaining) part of the `byte` to the `buffer`
-        //    (00000100 in this example)
-        buffer |= (byte >> (8 - count));
-        writeBuf();
-        buffer = byte << count;
-    }
-
-    // Empty the currently in-process `buffer` by filling it with 'bit'
+    // Empty the currently in-process byte by filling it with 'bit'
     // (all unused right-most bits will be filled with `bit`).
     void flush(bool bit) {
-        // `count` will become 8 after `buffer` is written out?
-        while (count != 8) {
-            writeBit(bit);
+        int pad_bits = (8 - acc_.bits % 8) % 8;
+        writeBits(bit ? 0xFF : 0x00, pad_bits);
+        emitCompletedBytes();
+    }
+
+    // Pointer to the bytes written so far (only whole bytes, see `flush`).
+    // Empty in the stream mode as all the bytes are already passed to the stream.
+    [[nodiscard]] const uint8_t *data() const {
+        return external_ != nullptr ? external_ : buffer_.data();
+    }
+
+    // Number of whole bytes available via `data`.
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    // Number of bytes allocated for `data` (`size` of them are written).
+    [[nodiscard]] size_t capacity() const {
+        return capacity_;
+    }
+
+    // Total number of bits written, including the ones still kept in the accumulator.
+    [[nodiscard]] uint64_t bitSize() const {
+        return (drained_ + size_) * 8 + acc_.bits;
+    }
+
+    // Append the bits written so far (only in the internal buffer mode) to `out` without flushing them,
+    // the last byte is padded with zeros.
+    void copyTo(std::vector<uint8_t> &out) const {
+        out.insert(out.end(), buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(size_));
+        for (int bits = 0; bits < acc_.bits; bits += 8) {
+            out.push_back(static_cast<uint8_t>(acc_.word >> (56 - bits)));
         }
     }
 
+    // Whether the caller-provided memory was too small and `data` now points to the internal buffer.
+    [[nodiscard]] bool overflowed() const {
+        return overflowed_;
+    }
+
+    // Move the internal buffer out of the writer (only in the internal buffer mode).
+    std::vector<uint8_t> release() {
+        buffer_.resize(size_);
+        size_ = 0;
+        capacity_ = 0;
+        return std::move(buffer_);
+    }
+
 private:
-    void writeBuf() {
-        auto casted_buffer = reinterpret_cast<const char *>(&buffer);
-        out.write(casted_buffer, sizeof(buffer));
+    void emitWord(uint64_t word) {
+        uint8_t *dst = reserve(sizeof(uint64_t));
+        if constexpr (std::endian::native == std::endian::little) {
+            word = __builtin_bswap64(word);
+        }
+        std::memcpy(dst, &word, sizeof(word));
+        size_ += sizeof(uint64_t);
+    }
+
+    // Move whole bytes of the accumulator into the buffer.
+    void emitCompletedBytes() {
+        while (acc_.bits >= 8) {
+            *reserve(1) = static_cast<uint8_t>(acc_.word >> 56);
+            size_++;
+            acc_.word <<= 8;
+            acc_.bits -= 8;
+        }
     }
 
-    std::ostream &out;
-    uint8_t buffer;
-    // How many right-most bits are available for writing in the current byte (the last byte of the buffer).
-    uint8_t count;
+    // Return a pointer to at least `n` bytes of free space after the written ones.
+    uint8_t *reserve(size_t n) {
+        if (size_ + n > capacity_) {
+            if (external_ != nullptr) {
+                buffer_.assign(external_, external_ + size_);
+                external_ = nullptr;
+                overflowed_ = true;
+            }
+            capacity_ = std::max(capacity_ * 2, size_ + std::max<size_t>(n, 64));
+            buffer_.resize(capacity_);
+        }
+        return (external_ != nullptr ? external_ : buffer_.data()) + size_;
+    }
+
+    void syncStream() {
+        emitCompletedBytes();
+        if (size_ == 0) {
+            return;
+        }
+        out_->write(reinterpret_cast<const char *>(data()), static_cast<std::streamsize>(size_));
+        drained_ += size_;
+        size_ = 0;
+    }
+
+    std::ostream *out_ = nullptr;
+    uint8_t *external_ = nullptr;
+    std::vector<uint8_t> buffer_;
+    // Number of bytes written to `data()`.
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    // Number of bytes already passed to `out_`.
+    size_t drained_ = 0;
+    bool overflowed_ = false;
+    BitAccumulator acc_;
+};
+
+// Requirements for the bit sink of the encoders below.
+template<typename W>
+concept BitWriterLike = requires(W w, uint64_t u64, int nbits, bool bit) {
+    w.writeBit(bit);
+    w.writeBits(u64, nbits);
+    w.flush(bit);
 };
 
 constexpr int32_t
         FIRST_DELTA_BITS = 14;
 
 uint8_t leadingZeros(uint64_t v) {
-    uint64_t mask = 0x8000000000000000;
-    uint8_t ret = 0;
-    while (ret < 64 && (v & mask) == 0) {
-        mask >>= 1;
-        ret++;
-    }
-    return ret;
+    return std::countl_zero(v);
 }
 
 uint8_t trailingZeros(uint64_t v) {
-    uint64_t mask = 0x0000000000000001;
-    uint8_t ret = 0;
-    while (ret < 64 && (v & mask) == 0) {
-        mask <<= 1;
-        ret++;
-    }
-    return ret;
+    return std::countr_zero(v);
 }
 
+// Header window of the timestamps in seconds (2 hours).
+constexpr uint64_t HEADER_WINDOW_SECONDS = 60 * 60 * 2;
+
 // Header is a first time aligned to 2 hours window.
 //
 // We need header, because it helps us to deal with a case when `finish`
 // was called without `compress`
-uint64_t getHeaderFromTimestamp(uint64_t first_time) {
-    auto seconds_after_2_hour_window = first_time % (60 * 60 * 2);
+uint64_t getHeaderFromTimestamp(uint64_t first_time, uint64_t window = HEADER_WINDOW_SECONDS) {
+    auto seconds_after_2_hour_window = first_time % window;
     return first_time - seconds_after_2_hour_window;
 }
 
-template<typename T>
-class CompressorBase {
-public:
-    explicit CompressorBase(std::shared_ptr<BitWriter> bw) : bw_(std::move(bw)), first_compressed_(false) {}
+// Timestamps `t` are encoded as `(t - remainder) / step`, all of them must have the same remainder
+// modulo `step`. The header window is 2 hours in these scaled units, and the first delta takes as
+// many bits as needed to hold it. The default scale is the original format of second timestamps.
+struct TimestampsScale {
+    uint64_t step = 1;
+    uint64_t remainder = 0;
+    uint64_t window = HEADER_WINDOW_SECONDS;
+    int first_delta_bits = FIRST_DELTA_BITS;
+
+    // Scale of timestamps of `units_per_second` resolution being `remainder` modulo `step`.
+    static TimestampsScale Make(uint64_t units_per_second, uint64_t step, uint64_t remainder) {
+        TimestampsScale scale;
+        scale.step = std::max<uint64_t>(step, 1);
+        scale.remainder = remainder % scale.step;
+        scale.window = std::max<uint64_t>(HEADER_WINDOW_SECONDS * units_per_second / scale.step, 1);
+        scale.first_delta_bits = std::max(FIRST_DELTA_BITS, static_cast<int32_t>(std::bit_width(scale.window)));
+        return scale;
+    }
 
-    virtual ~CompressorBase() = default;
+    [[nodiscard]] bool isDefault() const {
+        return step == 1 && remainder == 0 && window == HEADER_WINDOW_SECONDS && first_delta_bits == FIRST_DELTA_BITS;
+    }
 
-    void compressFirst(T entity) {
-        compressFirstInner(entity);
-        first_compressed_ = true;
+    [[nodiscard]] uint64_t scaled(uint64_t t) const {
+        return (t - remainder) / step;
     }
 
-    virtual void compressFirstInner(T) = 0;
+    [[nodiscard]] uint64_t unscaled(uint64_t t) const {
+        return t * step + remainder;
+    }
+};
 
-    virtual void compressNonFirst(T) = 0;
+// Greatest common divisor of the deltas between `ts` (1 if there are none), 1 when some of `ts`
+// are negative as signed numbers (their remainders would differ in the unsigned arithmetic).
+uint64_t detectTimestampsStep(std::span<const uint64_t> ts) {
+    uint64_t step = 0;
+    for (size_t i = 1; i < ts.size() && step != 1; i++) {
+        if (static_cast<int64_t>(ts[i]) < 0) {
+            return 1;
+        }
+        step = std::gcd(step, ts[i] > ts[0] ? ts[i] - ts[0] : ts[0] - ts[i]);
+    }
+    return std::max<uint64_t>(step, 1);
+}
+
+// Compile-time specialized encoders.
+//
+// Encoders are parametrized by the bit sink (`Writer`) and keep a reference to it, so the whole
+// per-point path (including `BitWriter` calls) may be inlined into the caller's loop.
+// `Derived` must provide `compressFirstInner`, `compressNonFirst` and `finish`, and may provide
+// `flushPending` writing entities it buffers.
+//
+// A series is ended either with `finish`, which writes the end marker of the encoder, or with
+// `finishCounted`, which writes no marker: the number of entities is then stored by the caller
+// (see `FormatVersion::COUNTED`) and the series is read back with `DecoderBase::decodeCounted`.
+template<typename Derived, BitWriterLike Writer, typename T>
+class EncoderBase {
+public:
+    explicit EncoderBase(Writer &bw) : bw_(bw) {}
+
+    void compressFirst(T entity) {
+        self().compressFirstInner(entity);
+        first_compressed_ = true;
+    }
 
     void compress(T entity) {
-        if (first_compressed_) {
-            compressNonFirst(entity);
+        if (first_compressed_) [[likely]] {
+            self().compressNonFirst(entity);
         } else {
             compressFirst(entity);
         }
     }
 
-    virtual void finish() = 0;
+    [[nodiscard]] bool firstCompressed() const {
+        return first_compressed_;
+    }
+
+    void finishCounted() {
+        if constexpr (requires(Derived &d) { d.flushPending(); }) {
+            self().flushPending();
+        }
+        bw_.flush(false);
+    }
 
 protected:
-    std::shared_ptr<BitWriter> bw_;
-    bool first_compressed_;
+    Derived &self() {
+        return static_cast<Derived &>(*this);
+    }
+
+    Writer &bw_;
+    bool first_compressed_ = false;
 };
 
-class TimestampsCompressor : public CompressorBase<uint64_t> {
+template<BitWriterLike Writer = BitWriter>
+class TimestampsEncoder : public EncoderBase<TimestampsEncoder<Writer>, Writer, uint64_t> {
+    using Base = EncoderBase<TimestampsEncoder<Writer>, Writer, uint64_t>;
+    using Base::bw_;
+    using Base::first_compressed_;
+
 public:
-    explicit TimestampsCompressor(std::shared_ptr<BitWriter> bw) : CompressorBase(std::move(bw)), header_(0) {}
+    explicit TimestampsEncoder(Writer &bw, const TimestampsScale &scale = {}) : Base(bw), scale_(scale) {}
+
+    // State after the last compressed timestamp (in the scaled units), which is enough to continue
+    // the series with another encoder (see `restore`).
+    struct State {
+        uint64_t header = 0;
+        uint64_t t = 0;
+        int64_t t_delta = 0;
+    };
+
+    [[nodiscard]] State state() const {
+        return {header_, t_, t_delta_};
+    }
+
+    // Continue the series which has `state` after its last timestamp, the writer must be positioned
+    // right after the last bit of the series.
+    void restore(const State &state) {
+        header_ = state.header;
+        t_ = state.t;
+        t_delta_ = state.t_delta;
+        first_compressed_ = true;
+    }
+
+    // Upper bound of the compressed size in bytes of `n` timestamps (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        // Header + first delta (of up to 64 bits when scaled), `n` of the widest DoDs
+        // (4 bits prefix + 64 bits), end marker.
+        return (64 + 64 + n * (4 + 64) + (4 + 64 + 1) + 7) / 8;
+    }
 
-    void compressFirstInner(uint64_t t) override {
-        header_ = getHeaderFromTimestamp(t);
-        bw_->writeBits(header_, 64);
+    void compressFirstInner(uint64_t t) {
+        t = scale_.scaled(t);
+        header_ = getHeaderFromTimestamp(t, scale_.window);
+        bw_.writeBits(header_, 64);
         if (t - header_ < 0) {
             std::cerr << "First time passed for compression is less than header." << std::endl;
             std::cerr << "Header: " << header_ << ". Time: " << t << "." << std::endl;
@@ -192,10 +439,11 @@ public:
         int64_t delta = static_cast<int64_t>(t) - static_cast<int64_t>(header_);
         t_ = t;
         t_delta_ = delta;
-        bw_->writeBits(delta, FIRST_DELTA_BITS);
+        bw_.writeBits(delta, scale_.first_delta_bits);
     }
 
-    void compressNonFirst(uint64_t t) override {
+    void compressNonFirst(uint64_t t) {
+        t = scale_.scaled(t);
         auto delta = static_cast<int64_t>(t) - static_cast<int64_t>(t_);
         int64_t dod = delta - t_delta_;
 
@@ -203,36 +451,38 @@ public:
         t_delta_ = delta;
 
         if (dod == 0) {
-            bw_->writeBit(false);
+            bw_.writeBit(false);
         } else if (-63 <= dod && dod <= 64) {
-            bw_->writeBits(0x02, 2);
+            bw_.writeBits(0x02, 2);
             writeInt64Bits(dod, 7);
         } else if (-255 <= dod && dod <= 256) {
-            bw_->writeBits(0x06, 3);
+            bw_.writeBits(0x06, 3);
             writeInt64Bits(dod, 9);
         } else if (-2047 <= dod && dod <= 2048) {
-            bw_->writeBits(0x0E, 4);
+            bw_.writeBits(0x0E, 4);
             writeInt64Bits(dod, 12);
         } else {
-            bw_->writeBits(0x0F, 4);
+            bw_.writeBits(0x0F, 4);
             writeInt64Bits(dod, 64);
         }
     }
 
-    void finish() override {
+    void finish() {
         if (!first_compressed_) {
-            bw_->writeBits((1 << FIRST_DELTA_BITS) - 1, FIRST_DELTA_BITS);
-            bw_->writeBits(0, 64);
-            bw_->flush(false);
+            // Empty header and the first delta read back as the end of the series by
+            // `TimestampsDecoder::decompressFirstInner`.
+            bw_.writeBits(0, 64);
+            bw_.writeBits(UINT64_MAX, scale_.first_delta_bits);
+            bw_.flush(false);
             return;
         }
 
         // 0x0F           = 00001111 -> 1111 (cutted).
-        bw_->writeBits(0x0F, 4);
+        bw_.writeBits(0x0F, 4);
         // 0xFFFFFFFF     = 11111111 11111111 11111111 11111111
-        bw_->writeBits(0xFFFFFFFFFFFFFFFF, 64);
-        bw_->writeBit(false);
-        bw_->flush(false);
+        bw_.writeBits(0xFFFFFFFFFFFFFFFF, 64);
+        bw_.writeBit(false);
+        bw_.flush(false);
     }
 
 private:
@@ -243,608 +493,4576 @@ private:
         } else {
             u = static_cast<uint64_t>((1 << nbits) + i);
         }
-        bw_->writeBits(u, int(nbits));
+        bw_.writeBits(u, int(nbits));
     }
 
+    TimestampsScale scale_;
     // Header bits.
-    uint64_t header_;
-    // Last time passed for compression.
+    uint64_t header_ = 0;
+    // Last time passed for compression (scaled).
     uint64_t t_ = 0;
     // 1.) In case first (time, value) pair passed after header, find delta with header time.
     // 2.) Otherwise, last time delta with new passed time and `t_`.
     int64_t t_delta_ = 0;
 };
 
-class ValuesCompressor : public CompressorBase<uint64_t> {
+// `V` is an unsigned integer type defining the width of encoded values. All the existing
+// serialized data uses 64 bits (values of narrower Arrow types are zero-extended).
+template<BitWriterLike Writer = BitWriter, std::unsigned_integral V = uint64_t>
+class ValuesEncoder : public EncoderBase<ValuesEncoder<Writer, V>, Writer, V> {
+    using Base = EncoderBase<ValuesEncoder<Writer, V>, Writer, V>;
+    using Base::bw_;
+    using Base::first_compressed_;
+
 public:
-    explicit ValuesCompressor(std::shared_ptr<BitWriter> bw) : CompressorBase(std::move(bw)),
-                                                               leading_zeros_(INT8_MAX) {}
+    static constexpr int VALUE_BITS = sizeof(V) * 8;
+
+    explicit ValuesEncoder(Writer &bw) : Base(bw) {}
+
+    // State after the last compressed value (see `TimestampsEncoder::State`).
+    struct State {
+        V value = 0;
+        uint8_t leading_zeros = 0;
+        uint8_t trailing_zeros = 0;
+    };
+
+    [[nodiscard]] State state() const {
+        return {value_, leading_zeros_, trailing_zeros_};
+    }
+
+    void restore(const State &state) {
+        value_ = state.value;
+        leading_zeros_ = state.leading_zeros;
+        trailing_zeros_ = state.trailing_zeros;
+        first_compressed_ = true;
+    }
+
+    // Upper bound of the compressed size in bytes of `n` values (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        // First value, `n` of values with a new window (2 control bits + 6 + 6 + value), end marker.
+        return (VALUE_BITS + n * (2 + 6 + 6 + VALUE_BITS) + (2 + 6 + 6) + 7) / 8;
+    }
 
-    void compressFirstInner(uint64_t v) override {
+    void compressFirstInner(V v) {
         value_ = v;
-        bw_->writeBits(value_, 64);
+        bw_.writeBits(value_, VALUE_BITS);
     }
 
-    void compressNonFirst(uint64_t v) override {
-        uint64_t xor_val = value_ ^ v;
+    void compressNonFirst(V v) {
+        V xor_val = value_ ^ v;
         value_ = v;
 
         if (xor_val == 0) {
-            bw_->writeBit(false);
+            bw_.writeBit(false);
             return;
         }
 
-        uint8_t leading_zeros_val = leadingZeros(xor_val);
-        uint8_t trailing_zeros_val = trailingZeros(xor_val);
+        uint8_t leading_zeros_val = std::countl_zero(xor_val);
+        uint8_t trailing_zeros_val = std::countr_zero(xor_val);
 
-        bw_->writeBit(true);
+        bw_.writeBit(true);
 
         if (leading_zeros_ <= leading_zeros_val && trailing_zeros_ <= trailing_zeros_val) {
-            bw_->writeBit(false);
-            int significant_bits = 64 - leading_zeros_ - trailing_zeros_;
-            bw_->writeBits(xor_val >> trailing_zeros_, significant_bits);
+            bw_.writeBit(false);
+            int significant_bits = VALUE_BITS - leading_zeros_ - trailing_zeros_;
+            bw_.writeBits(xor_val >> trailing_zeros_, significant_bits);
             return;
         }
 
         leading_zeros_ = leading_zeros_val;
         trailing_zeros_ = trailing_zeros_val;
 
-        bw_->writeBit(true);
-        bw_->writeBits(leading_zeros_, 6);
-        int significant_bits = 64 - leading_zeros_ - trailing_zeros_;
-        bw_->writeBits(static_cast<uint64_t>(significant_bits), 6);
-        bw_->writeBits(xor_val >> trailing_zeros_val, significant_bits);
+        bw_.writeBit(true);
+        bw_.writeBits(leading_zeros_, 6);
+        int significant_bits = VALUE_BITS - leading_zeros_ - trailing_zeros_;
+        bw_.writeBits(static_cast<uint64_t>(significant_bits), 6);
+        bw_.writeBits(xor_val >> trailing_zeros_val, significant_bits);
     }
 
-    void finish() override {
+    void finish() {
         if (!first_compressed_) {
-            bw_->writeBits(0, 64);
-            bw_->flush(false);
+            // Read back as the end of the series by `ValuesDecoder::decompressFirstInner`.
+            bw_.writeBits(std::numeric_limits<V>::max(), VALUE_BITS);
+            bw_.flush(false);
             return;
         }
 
-        bw_->writeBit(true);
-        bw_->writeBit(true);
+        bw_.writeBit(true);
+        bw_.writeBit(true);
 
         // 0x3F = 00111111 -> 111111 (cutted).
-        bw_->writeBits(0x3F, 6);
-        bw_->writeBits(0x3F, 6);
-        bw_->flush(false);
+        bw_.writeBits(0x3F, 6);
+        bw_.writeBits(0x3F, 6);
+        bw_.flush(false);
     }
 
 private:
-    uint8_t leading_zeros_ = 0;
+    uint8_t leading_zeros_ = INT8_MAX;
     uint8_t trailing_zeros_ = 0;
     // Last value passed for compression.
-    uint64_t value_ = 0;
+    V value_ = 0;
 };
 
-// Diff from initial article implementation:
-// 1.) Leading zeroes are encoded and decoded as 6 bits and not as 5 (as it's done in the article).
-// 2.) Max DOD encoded as 64 bits and not as 32.
-// 3.) Unable to decompress 0xFFFFFFFFFFFFFFFF as value as currently it's reserved as a flag of series end.
-class PairsCompressor : public CompressorBase<std::pair<uint64_t, uint64_t>> {
-public:
-    explicit PairsCompressor(const std::shared_ptr<BitWriter> &bw) : CompressorBase(bw), compressor_ts_(bw),
-                                                                     compressor_value_(bw) {}
-
-    void compressFirstInner(std::pair<uint64_t, uint64_t> entity) override {
-        auto [t, v] = entity;
-        compressor_ts_.compressFirst(t);
-        compressor_value_.compressFirst(v);
+// Chimp (https://www.vldb.org/pvldb/vol15/p3058-liakos.pdf) parameters.
+//
+// Leading zeros of a XOR are rounded down to one of 8 buckets, the bucket is encoded as 3 bits.
+constexpr uint8_t CHIMP_LEADING_BUCKETS[8] = {0, 8, 12, 16, 18, 20, 22, 24};
+
+// Bucket of every possible number of leading zeros.
+constexpr auto CHIMP_LEADING_REPRESENTATION = [] {
+    std::array<uint8_t, 65> table{};
+    uint8_t bucket = 0;
+    for (int leading_zeros = 0; leading_zeros <= 64; leading_zeros++) {
+        if (bucket + 1 < 8 && leading_zeros >= CHIMP_LEADING_BUCKETS[bucket + 1]) {
+            bucket++;
+        }
+        table[leading_zeros] = bucket;
     }
+    return table;
+}();
+
+// XOR with more trailing zeros is written without them.
+constexpr int CHIMP_TRAILING_THRESHOLD = 6;
+// Number of previous values Chimp128 looks up the best XOR among, and bits of their index.
+constexpr size_t CHIMP128_PREVIOUS_VALUES = 128;
+constexpr int CHIMP128_INDEX_BITS = 7;
+// Chimp128 takes values with the same lowest `CHIMP128_KEY_BITS` bits as candidates,
+// so XOR with more than `CHIMP128_TRAILING_THRESHOLD` trailing zeros is guaranteed.
+constexpr int CHIMP128_TRAILING_THRESHOLD = CHIMP_TRAILING_THRESHOLD + CHIMP128_INDEX_BITS;
+constexpr int CHIMP128_KEY_BITS = CHIMP128_TRAILING_THRESHOLD + 1;
+// Stored leading zeros never matching the rounded ones.
+constexpr uint8_t CHIMP_NO_LEADING_ZEROS = 65;
+
+// Chimp values encoder (better suited for floating point values than `ValuesEncoder`):
+// 00                                       -> same value
+// 01 + 3 bits leading + 6 bits length + XOR -> XOR without trailing zeros
+// 10 + XOR                                 -> XOR without the leading zeros of the previous one
+// 11 + 3 bits leading + XOR                -> XOR without new (rounded) leading zeros
+//
+// The stream starts with a bit telling whether the series is non-empty, `01` with zero length
+// ends the series (so any value, including 0xFFFFFFFFFFFFFFFF, can be encoded).
+template<BitWriterLike Writer = BitWriter>
+class ChimpEncoder : public EncoderBase<ChimpEncoder<Writer>, Writer, uint64_t> {
+    using Base = EncoderBase<ChimpEncoder<Writer>, Writer, uint64_t>;
+    using Base::bw_;
+    using Base::first_compressed_;
 
-    void compressNonFirst(std::pair<uint64_t, uint64_t> entity) override {
-        auto [t, v] = entity;
-        compressor_ts_.compressNonFirst(t);
-        compressor_value_.compressNonFirst(v);
-    }
+public:
+    explicit ChimpEncoder(Writer &bw) : Base(bw) {}
 
-    void finish() override {
-        compressor_ts_.finish();
+    // Upper bound of the compressed size in bytes of `n` values (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        // Flag + first value, `n` of XORs with new leading zeros (5 control bits + 64), end marker.
+        return (1 + 64 + n * (5 + 64) + (2 + 3 + 6) + 7) / 8;
     }
 
-private:
-    TimestampsCompressor compressor_ts_;
-    ValuesCompressor compressor_value_;
-};
-// ---------- COMPRESSION ------------------
-
+    void compressFirstInner(uint64_t v) {
+        value_ = v;
+        bw_.writeBit(true);
+        bw_.writeBits(value_, 64);
+    }
 
+    void compressNonFirst(uint64_t v) {
+        uint64_t xor_val = value_ ^ v;
+        value_ = v;
 
-// ---------- DECOMPRESSION ----------------
-class BitReader {
-public:
-    explicit BitReader(std::istream &is) : in(is), buffer_(0), count_(0) {}
+        if (xor_val == 0) {
+            bw_.writeBits(0b00, 2);
+            leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+            return;
+        }
 
-    // Read single bit from the stream.
-    bool readBit() {
-        if (count_ == 0) {
-            refreshBuffer();
-            count_ = 8;
-        }
-        count_--;
-
-        // 1.) Bitwise AND (0x80 = 10000000)
-        // 2.) Left shift buffer on 1 bit.
-        // 3.) If digit == 1, return true, false -- otherwise.
-        uint8_t digit = (buffer_ & 0x80);
-        buffer_ <<= 1;
-        bool res = digit != 0;
-        return res;
+        uint8_t bucket = CHIMP_LEADING_REPRESENTATION[std::countl_zero(xor_val)];
+        uint8_t leading_zeros = CHIMP_LEADING_BUCKETS[bucket];
+        int trailing_zeros = std::countr_zero(xor_val);
+        if (trailing_zeros > CHIMP_TRAILING_THRESHOLD) {
+            int significant_bits = 64 - leading_zeros - trailing_zeros;
+            bw_.writeBits((0b01 << 9) | (bucket << 6) | significant_bits, 11);
+            bw_.writeBits(xor_val >> trailing_zeros, significant_bits);
+            leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+        } else if (leading_zeros == leading_zeros_) {
+            bw_.writeBits(0b10, 2);
+            bw_.writeBits(xor_val, 64 - leading_zeros);
+        } else {
+            leading_zeros_ = leading_zeros;
+            bw_.writeBits((0b11 << 3) | bucket, 5);
+            bw_.writeBits(xor_val, 64 - leading_zeros);
+        }
     }
 
-    // Read single byte from the stream.
-    uint8_t readByte() {
-        if (count_ == 0) {
-            refreshBuffer();
-            return buffer_;
+    void finish() {
+        if (!first_compressed_) {
+            bw_.writeBit(false);
+        } else {
+            bw_.writeBits(0b01 << 9, 11);
         }
-        uint8_t byte = buffer_;
-        refreshBuffer();
-        byte |= (buffer_ >> count_);
-        buffer_ <<= (8 - count_);
-        return byte;
+        bw_.flush(false);
     }
 
-    // Read `nbits` bits from the stream.
-    uint64_t readBits(int nbits) {
-        uint64_t u64 = 0;
+private:
+    uint8_t leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+    uint64_t value_ = 0;
+};
 
-        while (nbits >= 8) {
-            uint8_t byte = readByte();
-            u64 = (u64 << 8) | static_cast<uint64_t>(byte);
-            nbits -= 8;
-        }
+// Chimp128 values encoder: same as `ChimpEncoder`, but XOR is taken against the one of the last
+// 128 values sharing the lowest bits with the value (if any), which index is written in `00` and
+// `01` cases:
+// 00 + 7 bits index                                   -> same value as the indexed one
+// 01 + 7 bits index + 3 bits leading + 6 bits length + XOR -> XOR with the indexed one
+// 10 + XOR, 11 + 3 bits leading + XOR                 -> XOR with the previous value
+template<BitWriterLike Writer = BitWriter>
+class Chimp128Encoder : public EncoderBase<Chimp128Encoder<Writer>, Writer, uint64_t> {
+    using Base = EncoderBase<Chimp128Encoder<Writer>, Writer, uint64_t>;
+    using Base::bw_;
+    using Base::first_compressed_;
 
-        while (nbits > 0) {
-            uint8_t byte = readBit();
-            u64 <<= 1;
-            if (byte) {
-                u64 |= 1;
-            }
-            nbits--;
-        }
+public:
+    explicit Chimp128Encoder(Writer &bw) : Base(bw), indices_(size_t(1) << CHIMP128_KEY_BITS) {}
 
-        return u64;
+    // Upper bound of the compressed size in bytes of `n` values (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        return (1 + 64 + n * (5 + 64) + (2 + CHIMP128_INDEX_BITS + 3 + 6) + 7) / 8;
     }
 
-private:
-    // Read a new byte from the stream.
-    void refreshBuffer() {
-        char read_byte;
-        in.read(&read_byte, 1);
-        buffer_ = read_byte;
+    void compressFirstInner(uint64_t v) {
+        bw_.writeBit(true);
+        bw_.writeBits(v, 64);
+        store(v);
     }
 
-    std::istream &in;
-    uint8_t buffer_;
-    // How many right-most bits are available for reading in the current byte.
-    // Note: reading is applied from left to right.
-    uint8_t count_;
-};
-
-template<typename T>
-class DecompressorBase {
-public:
-    explicit DecompressorBase(std::shared_ptr<BitReader> bw) : br_(std::move(bw)), first_decompressed_(false) {}
+    void compressNonFirst(uint64_t v) {
+        size_t previous_index = (index_ - 1) % CHIMP128_PREVIOUS_VALUES;
+        uint64_t xor_val = values_[previous_index] ^ v;
+        int trailing_zeros = 0;
+
+        uint64_t candidate = indices_[keyOf(v)];
+        if (candidate != 0 && index_ - candidate < CHIMP128_PREVIOUS_VALUES) {
+            size_t candidate_index = (candidate - 1) % CHIMP128_PREVIOUS_VALUES;
+            uint64_t candidate_xor = values_[candidate_index] ^ v;
+            trailing_zeros = std::countr_zero(candidate_xor);
+            if (trailing_zeros > CHIMP128_TRAILING_THRESHOLD) {
+                previous_index = candidate_index;
+                xor_val = candidate_xor;
+            }
+        }
 
-    virtual ~DecompressorBase() = default;
+        if (xor_val == 0) {
+            bw_.writeBits(previous_index, 2 + CHIMP128_INDEX_BITS);
+            leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+            store(v);
+            return;
+        }
 
-    std::optional<T> next() {
-        if (first_decompressed_) {
-            return decompressNonFirst();
+        uint8_t bucket = CHIMP_LEADING_REPRESENTATION[std::countl_zero(xor_val)];
+        uint8_t leading_zeros = CHIMP_LEADING_BUCKETS[bucket];
+        if (trailing_zeros > CHIMP128_TRAILING_THRESHOLD) {
+            int significant_bits = 64 - leading_zeros - trailing_zeros;
+            uint64_t control = (((0b01 << CHIMP128_INDEX_BITS) | previous_index) << 9) | (bucket << 6) | significant_bits;
+            bw_.writeBits(control, 2 + CHIMP128_INDEX_BITS + 3 + 6);
+            bw_.writeBits(xor_val >> trailing_zeros, significant_bits);
+            leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+        } else if (leading_zeros == leading_zeros_) {
+            bw_.writeBits(0b10, 2);
+            bw_.writeBits(xor_val, 64 - leading_zeros);
         } else {
-            return {decompressFirst() };
+            leading_zeros_ = leading_zeros;
+            bw_.writeBits((0b11 << 3) | bucket, 5);
+            bw_.writeBits(xor_val, 64 - leading_zeros);
         }
+        store(v);
     }
 
-    std::optional<T> decompressFirst() {
-        auto res = decompressFirstInner();
-        if (res) {
-            first_decompressed_ = true;
+    void finish() {
+        if (!first_compressed_) {
+            bw_.writeBit(false);
+        } else {
+            bw_.writeBits(uint64_t(0b01) << (CHIMP128_INDEX_BITS + 9), 2 + CHIMP128_INDEX_BITS + 3 + 6);
         }
-        return res;
+        bw_.flush(false);
     }
 
 private:
-    virtual std::optional<T> decompressFirstInner() = 0;
+    static size_t keyOf(uint64_t v) {
+        return v & ((uint64_t(1) << CHIMP128_KEY_BITS) - 1);
+    }
 
-    virtual std::optional<T> decompressNonFirst() = 0;
+    void store(uint64_t v) {
+        values_[index_ % CHIMP128_PREVIOUS_VALUES] = v;
+        index_++;
+        indices_[keyOf(v)] = index_;
+    }
 
-protected:
-    std::shared_ptr<BitReader> br_;
-    bool first_decompressed_ = true;
+    uint8_t leading_zeros_ = CHIMP_NO_LEADING_ZEROS;
+    // Last `CHIMP128_PREVIOUS_VALUES` values, the value number `i` is stored at `i % 128`.
+    std::array<uint64_t, CHIMP128_PREVIOUS_VALUES> values_{};
+    // Number of stored values.
+    uint64_t index_ = 0;
+    // Number of the last value with the key plus one (0 if none) by the key.
+    std::vector<uint64_t> indices_;
 };
 
-class TimestampsDecompressor : public DecompressorBase<uint64_t> {
-public:
-    explicit TimestampsDecompressor(std::shared_ptr<BitReader> br) : DecompressorBase(std::move(br)) {}
+template<std::unsigned_integral U>
+void storeLittleEndian(uint8_t *out, U u) {
+    for (size_t i = 0; i < sizeof(U); i++) {
+        out[i] = static_cast<uint8_t>(u >> (8 * i));
+    }
+}
 
-    [[nodiscard]] uint64_t getHeader() const {
-        return header_;
+template<std::unsigned_integral U>
+U readLittleEndian(const uint8_t *in) {
+    U u = 0;
+    for (size_t i = 0; i < sizeof(U); i++) {
+        u |= static_cast<U>(in[i]) << (8 * i);
     }
+    return u;
+}
 
-    std::optional<uint64_t> decompressFirstInner() override {
-        header_ = br_->readBits(64);
-        uint64_t delta_u64 = br_->readBits(FIRST_DELTA_BITS);
-        int64_t delta = *reinterpret_cast<int64_t *>(&delta_u64);
+uint64_t zigzagEncode(uint64_t delta) {
+    return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
 
-        if (delta == ((1 << FIRST_DELTA_BITS) - 1)) {
-            return std::nullopt;
-        }
+uint64_t zigzagDecode(uint64_t zigzag) {
+    return (zigzag >> 1) ^ (0 - (zigzag & 1));
+}
 
-        t_delta_ = delta;
-        t_ = header_ + t_delta_;
-        return {t_};
+// Number of values of a full miniblock of `IntegerEncoder`.
+constexpr size_t INTEGER_MINIBLOCK_SIZE = 128;
+// Width byte ending an `IntegerEncoder` stream.
+constexpr uint8_t INTEGER_END_MARKER = 0xFF;
+// Flag of the width byte of a miniblock with packed values rather than deltas.
+constexpr uint8_t INTEGER_PLAIN_MODE = 0x80;
+// Miniblock header: width, number of values minus one, first value and base (both u64).
+constexpr size_t INTEGER_MINIBLOCK_HEADER_SIZE = 1 + 1 + 8 + 8;
+// Packed data is padded with this many bytes, so that unpacking may always load whole words.
+constexpr size_t INTEGER_PACKED_PADDING = 16;
+
+// Pack `n` values of `width` bits each LSB-first into `(n * width + 7) / 8` bytes of `out`.
+// `out` must have `INTEGER_PACKED_PADDING` more bytes, which are zeroed.
+void packBits(const uint64_t *in, size_t n, int width, uint8_t *out) {
+    size_t bytes = (n * width + 7) / 8;
+    std::memset(out, 0, bytes + INTEGER_PACKED_PADDING);
+    if (width == 0) {
+        return;
+    }
+    size_t bit = 0;
+    for (size_t i = 0; i < n; i++, bit += width) {
+        uint8_t *p = out + bit / 8;
+        int shift = static_cast<int>(bit % 8);
+        storeLittleEndian(p, readLittleEndian<uint64_t>(p) | in[i] << shift);
+        if (shift + width > 64) {
+            p[8] |= static_cast<uint8_t>(in[i] >> (64 - shift));
+        }
     }
+}
 
-    std::optional<uint64_t> decompressNonFirst() override {
-        uint8_t n = dodTimestampBits();
+// Integer values encoder: delta, zigzag and frame-of-reference encoding with a fixed bit width
+// per miniblock of up to `INTEGER_MINIBLOCK_SIZE` values. A miniblock is
+// [mode and width: u8][count - 1: u8][first value: u64][base: u64][count - 1 packed values]
+// where packed values are zigzag deltas minus their minimum `base`, `width` bits each
+// (see `packBits`), padded to a whole byte. When the values themselves are narrower than their
+// deltas (e.g. noise), `INTEGER_PLAIN_MODE` is set and the values minus `base` are packed instead.
+// Numbers are little-endian, `INTEGER_END_MARKER` in place of the mode and width ends the series.
+//
+// Miniblocks are byte-aligned and independent, so they are decoded with a plain unpack and
+// prefix sum instead of a bit-by-bit loop (see `IntegerDecoder`).
+template<BitWriterLike Writer = BitWriter>
+class IntegerEncoder : public EncoderBase<IntegerEncoder<Writer>, Writer, uint64_t> {
+    using Base = EncoderBase<IntegerEncoder<Writer>, Writer, uint64_t>;
+    using Base::bw_;
 
-        if (n == 0) {
-            t_ += t_delta_;
-            return t_;
-        }
+public:
+    explicit IntegerEncoder(Writer &bw) : Base(bw) {}
 
-        uint64_t bits = br_->readBits(n);
+    // Upper bound of the compressed size in bytes of `n` values (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        size_t miniblocks = (n + INTEGER_MINIBLOCK_SIZE - 1) / INTEGER_MINIBLOCK_SIZE;
+        return miniblocks * INTEGER_MINIBLOCK_HEADER_SIZE + n * 8 + 1;
+    }
 
-        if (n == 64 && bits == 0xFFFFFFFFFFFFFFFF) {
-            return std::nullopt;
+    void compressFirstInner(uint64_t v) {
+        compressNonFirst(v);
+    }
+
+    void compressNonFirst(uint64_t v) {
+        values_[size_++] = v;
+        if (size_ == INTEGER_MINIBLOCK_SIZE) {
+            flushMiniblock();
         }
+    }
 
-        int64_t bits_int64 = *reinterpret_cast<int64_t *>(&bits);
-        int64_t dod = bits_int64;
-        if (n != 64 && (1 << (n - 1)) < bits_int64) {
-            dod = bits_int64 - (1 << n);
+    void flushPending() {
+        if (size_ > 0) {
+            flushMiniblock();
         }
+    }
 
-        t_delta_ += dod;
-        t_ += t_delta_;
-        return t_;
+    void finish() {
+        flushPending();
+        bw_.writeBits(INTEGER_END_MARKER, 8);
+        bw_.flush(false);
     }
 
 private:
-    uint8_t dodTimestampBits() {
-        uint8_t dod = 0;
-        for (int i = 0; i < 4; i++) {
-            dod <<= 1;
-            bool bit = br_->readBit();
-            if (bit) {
-                dod |= 1;
-            } else {
-                break;
-            }
+    void flushMiniblock() {
+        std::array<uint64_t, INTEGER_MINIBLOCK_SIZE> deltas;
+        size_t n = size_ - 1;
+        uint64_t base = n > 0 ? UINT64_MAX : 0;
+        uint64_t max = 0;
+        uint64_t plain_base = base;
+        uint64_t plain_max = 0;
+        for (size_t i = 0; i < n; i++) {
+            deltas[i] = zigzagEncode(values_[i + 1] - values_[i]);
+            base = std::min(base, deltas[i]);
+            max = std::max(max, deltas[i]);
+            plain_base = std::min(plain_base, values_[i + 1]);
+            plain_max = std::max(plain_max, values_[i + 1]);
+        }
+        int width = 64 - std::countl_zero(max - base);
+        int plain_width = 64 - std::countl_zero(plain_max - plain_base);
+        uint8_t mode = 0;
+        if (plain_width < width) {
+            mode = INTEGER_PLAIN_MODE;
+            width = plain_width;
+            base = plain_base;
+            std::copy_n(values_.begin() + 1, n, deltas.begin());
+        }
+        for (size_t i = 0; i < n; i++) {
+            deltas[i] -= base;
         }
 
-        if (dod == 0x00) {
-            // Case of dod == 0.
-            return 0;
-        } else if (dod == 0x02) {
-            // Case of dod == 10.
-            return 7;
-        } else if (dod == 0x06) {
-            return 9;
-        } else if (dod == 0x0E) {
-            return 12;
-        } else if (dod == 0x0F) {
-            return 64;
+        std::array<uint8_t, INTEGER_MINIBLOCK_HEADER_SIZE + INTEGER_MINIBLOCK_SIZE * 8 + INTEGER_PACKED_PADDING> bytes;
+        bytes[0] = static_cast<uint8_t>(mode | width);
+        bytes[1] = static_cast<uint8_t>(n);
+        storeLittleEndian(bytes.data() + 2, values_[0]);
+        storeLittleEndian(bytes.data() + 10, base);
+        packBits(deltas.data(), n, width, bytes.data() + INTEGER_MINIBLOCK_HEADER_SIZE);
+        size_t size = INTEGER_MINIBLOCK_HEADER_SIZE + (n * width + 7) / 8;
+        if constexpr (requires { bw_.writeBytes(std::span<const uint8_t>()); }) {
+            bw_.writeBytes(std::span<const uint8_t>(bytes.data(), size));
         } else {
-            std::cerr << "invalid bit header for bit length to read" << std::endl;
-            exit(1);
+            for (size_t i = 0; i < size; i++) {
+                bw_.writeBits(bytes[i], 8);
+            }
         }
+        size_ = 0;
     }
 
-    uint64_t header_ = 0;
-    uint64_t t_ = 0;
-    int64_t t_delta_ = 0;
+    // Values of the current miniblock.
+    std::array<uint64_t, INTEGER_MINIBLOCK_SIZE> values_;
+    size_t size_ = 0;
 };
 
-class ValuesDecompressor : public DecompressorBase<uint64_t> {
+template<BitWriterLike Writer = BitWriter, std::unsigned_integral V = uint64_t>
+class PairsEncoder : public EncoderBase<PairsEncoder<Writer, V>, Writer, std::pair<uint64_t, V>> {
+    using Base = EncoderBase<PairsEncoder<Writer, V>, Writer, std::pair<uint64_t, V>>;
+
 public:
-    explicit ValuesDecompressor(std::shared_ptr<BitReader> br) : DecompressorBase(std::move(br)) {}
+    explicit PairsEncoder(Writer &bw, const TimestampsScale &scale = {})
+            : Base(bw), encoder_ts_(bw, scale), encoder_value_(bw) {}
 
-    std::optional<uint64_t> decompressFirstInner() override {
-        uint64_t value = br_->readBits(64);
+    // State after the last compressed pair (see `TimestampsEncoder::State`).
+    struct State {
+        typename TimestampsEncoder<Writer>::State ts;
+        typename ValuesEncoder<Writer, V>::State value;
+    };
 
-        if (value == 0xFFFFFFFFFFFFFFFF) {
-            return std::nullopt;
-        }
+    [[nodiscard]] State state() const {
+        return {encoder_ts_.state(), encoder_value_.state()};
+    }
 
-        return {value};
+    void restore(const State &state) {
+        encoder_ts_.restore(state.ts);
+        encoder_value_.restore(state.value);
+        this->first_compressed_ = true;
     }
 
-    std::optional<uint64_t> decompressNonFirst() override {
-        uint8_t read = 0;
-        for (int i = 0; i < 2; i++) {
-            bool bit = br_->readBit();
-            if (bit) {
-                read <<= 1;
-                read++;
-            } else {
-                break;
-            }
-        }
+    // Upper bound of the compressed size in bytes of `n` pairs (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        return TimestampsEncoder<Writer>::maxCompressedSize(n) + ValuesEncoder<Writer, V>::maxCompressedSize(n);
+    }
 
-        if (read == 0x1 || read == 0x3) {
-            if (read == 0x3) {
-                uint8_t leading_zeroes = br_->readBits(6);
-                uint8_t significant_bits = br_->readBits(6);
+    void compressFirstInner(std::pair<uint64_t, V> entity) {
+        auto [t, v] = entity;
+        encoder_ts_.compressFirst(t);
+        encoder_value_.compressFirst(v);
+    }
 
-                if (leading_zeroes == 0x3F && significant_bits == 0x3F) {
-                    return std::nullopt;
-                }
+    void compressNonFirst(std::pair<uint64_t, V> entity) {
+        auto [t, v] = entity;
+        encoder_ts_.compressNonFirst(t);
+        encoder_value_.compressNonFirst(v);
+    }
 
-                if (significant_bits == 0) {
-                    significant_bits = 64;
-                }
-                leading_zeros_ = leading_zeroes;
-                trailing_zeros_ = 64 - significant_bits - leading_zeros_;
+    // Compress `min(ts.size(), vs.size())` pairs in one loop.
+    void compressBatch(std::span<const uint64_t> ts, std::span<const V> vs) {
+        size_t size = std::min(ts.size(), vs.size());
+        size_t i = 0;
+        if (size > 0 && !this->first_compressed_) {
+            this->compressFirst({ts[0], vs[0]});
+            i++;
+        }
+        for (; i < size; i++) {
+            encoder_ts_.compressNonFirst(ts[i]);
+            encoder_value_.compressNonFirst(vs[i]);
+        }
+    }
+
+    void finish() {
+        encoder_ts_.finish();
+    }
+
+private:
+    TimestampsEncoder<Writer> encoder_ts_;
+    ValuesEncoder<Writer, V> encoder_value_;
+};
+
+// Runtime-polymorphic compressors interface over the encoders above sharing a `BitWriter`.
+template<typename T>
+class CompressorBase {
+public:
+    explicit CompressorBase(std::shared_ptr<BitWriter> bw) : bw_(std::move(bw)), first_compressed_(false) {}
+
+    virtual ~CompressorBase() = default;
+
+    void compressFirst(T entity) {
+        compressFirstInner(entity);
+        first_compressed_ = true;
+    }
+
+    virtual void compressFirstInner(T) = 0;
+
+    virtual void compressNonFirst(T) = 0;
+
+    void compress(T entity) {
+        if (first_compressed_) {
+            compressNonFirst(entity);
+        } else {
+            compressFirst(entity);
+        }
+    }
+
+    virtual void finish() = 0;
+
+protected:
+    std::shared_ptr<BitWriter> bw_;
+    bool first_compressed_;
+};
+
+// Adapter of `E` encoder to the `CompressorBase<T>` interface.
+template<typename T, typename E>
+class EncoderCompressor : public CompressorBase<T> {
+public:
+    explicit EncoderCompressor(std::shared_ptr<BitWriter> bw) : CompressorBase<T>(std::move(bw)),
+                                                                encoder_(*this->bw_) {}
+
+    void compressFirstInner(T entity) override {
+        encoder_.compressFirst(entity);
+    }
+
+    void compressNonFirst(T entity) override {
+        encoder_.compressNonFirst(entity);
+    }
+
+    void finish() override {
+        encoder_.finish();
+    }
+
+protected:
+    E encoder_;
+};
+
+class TimestampsCompressor : public EncoderCompressor<uint64_t, TimestampsEncoder<>> {
+public:
+    explicit TimestampsCompressor(std::shared_ptr<BitWriter> bw) : EncoderCompressor(std::move(bw)) {}
+};
+
+class ValuesCompressor : public EncoderCompressor<uint64_t, ValuesEncoder<>> {
+public:
+    explicit ValuesCompressor(std::shared_ptr<BitWriter> bw) : EncoderCompressor(std::move(bw)) {}
+};
+
+class ChimpCompressor : public EncoderCompressor<uint64_t, ChimpEncoder<>> {
+public:
+    explicit ChimpCompressor(std::shared_ptr<BitWriter> bw) : EncoderCompressor(std::move(bw)) {}
+};
+
+class Chimp128Compressor : public EncoderCompressor<uint64_t, Chimp128Encoder<>> {
+public:
+    explicit Chimp128Compressor(std::shared_ptr<BitWriter> bw) : EncoderCompressor(std::move(bw)) {}
+};
+
+class IntegerCompressor : public EncoderCompressor<uint64_t, IntegerEncoder<>> {
+public:
+    explicit IntegerCompressor(std::shared_ptr<BitWriter> bw) : EncoderCompressor(std::move(bw)) {}
+};
+
+// Format tag of a values stream, stored next to the stream so that the decoder picks the right codec.
+enum class ValuesCodec : uint8_t {
+    GORILLA = 0,
+    CHIMP = 1,
+    CHIMP128 = 2,
+    INTEGER = 3,
+    // Not stored, resolved by the column type by the Arrow helpers (see `resolveValuesCodec`).
+    AUTO = 0xFF,
+};
+
+// Upper bound of the compressed size in bytes of `n` values encoded with `codec`.
+constexpr size_t valuesMaxCompressedSize(ValuesCodec codec, size_t n) {
+    switch (codec) {
+        case ValuesCodec::CHIMP:
+            return ChimpEncoder<>::maxCompressedSize(n);
+        case ValuesCodec::CHIMP128:
+            return Chimp128Encoder<>::maxCompressedSize(n);
+        case ValuesCodec::INTEGER:
+            return IntegerEncoder<>::maxCompressedSize(n);
+        default:
+            return ValuesEncoder<>::maxCompressedSize(n);
+    }
+}
+
+// Call `func` with the encoder of `codec` writing to `bw`.
+template<typename F>
+void withValuesEncoder(ValuesCodec codec, BitWriter &bw, F &&func) {
+    switch (codec) {
+        case ValuesCodec::CHIMP: {
+            ChimpEncoder c(bw);
+            func(c);
+            break;
+        }
+        case ValuesCodec::CHIMP128: {
+            Chimp128Encoder c(bw);
+            func(c);
+            break;
+        }
+        case ValuesCodec::INTEGER: {
+            IntegerEncoder c(bw);
+            func(c);
+            break;
+        }
+        default: {
+            ValuesEncoder c(bw);
+            func(c);
+        }
+    }
+}
+
+// Diff from initial article implementation:
+// 1.) Leading zeroes are encoded and decoded as 6 bits and not as 5 (as it's done in the article).
+// 2.) Max DOD encoded as 64 bits and not as 32.
+// 3.) Unable to decompress 0xFFFFFFFFFFFFFFFF as the first value as it's reserved as a flag of series end
+//     (series ended with `finishCounted` have no reserved values).
+class PairsCompressor : public EncoderCompressor<std::pair<uint64_t, uint64_t>, PairsEncoder<>> {
+public:
+    explicit PairsCompressor(const std::shared_ptr<BitWriter> &bw) : EncoderCompressor(bw) {}
+
+    void compressBatch(std::span<const uint64_t> ts, std::span<const uint64_t> vs) {
+        encoder_.compressBatch(ts, vs);
+        first_compressed_ = encoder_.firstCompressed();
+    }
+};
+
+// Trailer of an appendable pairs stream: a `PairsEncoder` series ended with `finishCounted` is
+// followed by the number of its pairs, its size in bits and the encoder state after the last pair,
+// so the series may be continued without decoding it (see `appendTo`). Numbers are little-endian:
+// [count: u64][bit size: u64][header: u64][t: u64][t delta: u64][value: u64][leading zeros: u8][trailing zeros: u8]
+constexpr size_t PAIRS_TRAILER_SIZE = 6 * sizeof(uint64_t) + 2;
+
+struct PairsTrailer {
+    uint64_t count = 0;
+    uint64_t bit_size = 0;
+    PairsEncoder<>::State state;
+
+    void write(BitWriter &bw) const {
+        uint8_t bytes[PAIRS_TRAILER_SIZE];
+        storeLittleEndian(bytes, count);
+        storeLittleEndian(bytes + 8, bit_size);
+        storeLittleEndian(bytes + 16, state.ts.header);
+        storeLittleEndian(bytes + 24, state.ts.t);
+        storeLittleEndian(bytes + 32, static_cast<uint64_t>(state.ts.t_delta));
+        storeLittleEndian(bytes + 40, state.value.value);
+        bytes[48] = state.value.leading_zeros;
+        bytes[49] = state.value.trailing_zeros;
+        bw.writeBytes(bytes);
+    }
+
+    // Read the trailer from `PAIRS_TRAILER_SIZE` bytes at `data`.
+    static PairsTrailer read(const uint8_t *data) {
+        PairsTrailer trailer;
+        trailer.count = readLittleEndian<uint64_t>(data);
+        trailer.bit_size = readLittleEndian<uint64_t>(data + 8);
+        trailer.state.ts.header = readLittleEndian<uint64_t>(data + 16);
+        trailer.state.ts.t = readLittleEndian<uint64_t>(data + 24);
+        trailer.state.ts.t_delta = static_cast<int64_t>(readLittleEndian<uint64_t>(data + 32));
+        trailer.state.value.value = readLittleEndian<uint64_t>(data + 40);
+        trailer.state.value.leading_zeros = data[48];
+        trailer.state.value.trailing_zeros = data[49];
+        return trailer;
+    }
+};
+// ---------- COMPRESSION ------------------
+
+
+
+// ---------- DECOMPRESSION ----------------
+// Bits are read MSB-first through a 64-bit window that is refilled with a single unaligned
+// big-endian load while there are at least 8 bytes left, and byte by byte at the tail.
+// Reading past the end of the data yields zero bits.
+//
+// The reader can be used over:
+// * `BitReader(std::span<const uint8_t>)` -- memory that must outlive the reader;
+// * `BitReader(std::istream &)` -- the stream is read in `STREAM_CHUNK_SIZE` chunks into an
+//   internal buffer (so the stream may be consumed further than the bits actually read).
+class BitReader {
+public:
+    explicit BitReader(std::istream &is) : in_(&is) {}
+
+    explicit BitReader(std::span<const uint8_t> span) : data_(span.data()), size_(span.size()) {}
+
+    BitReader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+    BitReader(const BitReader &) = delete;
+
+    BitReader &operator=(const BitReader &) = delete;
+
+    // Read single bit from the stream.
+    bool readBit() {
+        if (window_bits_ == 0) {
+            refill();
+        }
+        bool res = (window_ >> 63) != 0;
+        window_ <<= 1;
+        window_bits_--;
+        return res;
+    }
+
+    // Read single byte from the stream.
+    uint8_t readByte() {
+        return static_cast<uint8_t>(readBits(8));
+    }
+
+    // Read `nbits` (up to 64) bits from the stream.
+    uint64_t readBits(int nbits) {
+        if (nbits > MAX_PEEK_BITS) {
+            uint64_t high = readBits(nbits - 32);
+            return (high << 32) | readBits(32);
+        }
+        uint64_t u64 = peekBits(nbits);
+        consume(nbits);
+        return u64;
+    }
+
+    // Return next `nbits` (up to `MAX_PEEK_BITS`) bits without advancing the position.
+    uint64_t peekBits(int nbits) {
+        if (nbits == 0) {
+            return 0;
+        }
+        if (window_bits_ < nbits) {
+            refill();
+        }
+        return window_ >> (64 - nbits);
+    }
+
+    // Advance the position by `nbits` bits.
+    void skipBits(uint64_t nbits) {
+        while (nbits > 0) {
+            if (window_bits_ == 0) {
+                refill();
+            }
+            int n = static_cast<int>(std::min<uint64_t>(nbits, window_bits_));
+            consume(n);
+            nbits -= n;
+        }
+    }
+
+    // Number of bits read (or skipped) so far.
+    [[nodiscard]] uint64_t bitPosition() const {
+        return (consumed_ + pos_) * 8 + padding_bits_ - window_bits_;
+    }
+
+    // Whether more bits were read than the data holds (the missing ones are read as zeros).
+    [[nodiscard]] bool pastEnd() const {
+        return padding_bits_ > static_cast<uint64_t>(window_bits_);
+    }
+
+    static constexpr int MAX_PEEK_BITS = 56;
+
+private:
+    // Drop `nbits` (<= `window_bits_`) leading bits of the window.
+    void consume(int nbits) {
+        window_ = nbits == 64 ? 0 : window_ << nbits;
+        window_bits_ -= nbits;
+    }
+
+    // Load as many whole bytes into the window as it can fit (at least 56 bits become available).
+    void refill() {
+        if (pos_ + sizeof(uint64_t) <= size_) {
+            uint64_t word;
+            std::memcpy(&word, data_ + pos_, sizeof(word));
+            if constexpr (std::endian::native == std::endian::little) {
+                word = __builtin_bswap64(word);
+            }
+            // Bits loaded past the whole bytes are loaded again (at the same position) on the
+            // next refill, so OR-ing them in here is harmless.
+            window_ |= word >> window_bits_;
+            int bytes = (63 - window_bits_) >> 3;
+            pos_ += bytes;
+            window_bits_ += bytes * 8;
+            return;
+        }
+
+        while (window_bits_ <= 56) {
+            if (pos_ == size_ && !loadChunk()) {
+                // Past the end of the data, pretend it's padded with zeros.
+                padding_bits_ += 64 - window_bits_;
+                window_bits_ = 64;
+                return;
+            }
+            window_ |= static_cast<uint64_t>(data_[pos_]) << (56 - window_bits_);
+            pos_++;
+            window_bits_ += 8;
+        }
+    }
+
+    // Read the next chunk of the stream into the internal buffer (only in the stream mode).
+    bool loadChunk() {
+        if (in_ == nullptr) {
+            return false;
+        }
+        consumed_ += pos_;
+        chunk_.resize(STREAM_CHUNK_SIZE);
+        in_->read(reinterpret_cast<char *>(chunk_.data()), static_cast<std::streamsize>(chunk_.size()));
+        data_ = chunk_.data();
+        size_ = static_cast<size_t>(in_->gcount());
+        pos_ = 0;
+        return size_ > 0;
+    }
+
+    static constexpr size_t STREAM_CHUNK_SIZE = 4096;
+
+    std::istream *in_ = nullptr;
+    std::vector<uint8_t> chunk_;
+    const uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+    // Next byte of `data_` to be loaded into the window.
+    size_t pos_ = 0;
+    // Number of bytes of the stream read before the current chunk.
+    size_t consumed_ = 0;
+    // Number of zero bits added to the window past the end of the data.
+    uint64_t padding_bits_ = 0;
+    // Bits to be read next, left-aligned.
+    uint64_t window_ = 0;
+    // How many left-most bits of `window_` are valid for reading.
+    int window_bits_ = 0;
+};
+
+// Requirements for the bit source of the decoders below.
+template<typename R>
+concept BitReaderLike = requires(R r, int nbits) {
+    { r.readBit() } -> std::convertible_to<bool>;
+    { r.readBits(nbits) } -> std::convertible_to<uint64_t>;
+    { r.peekBits(nbits) } -> std::convertible_to<uint64_t>;
+    r.skipBits(nbits);
+};
+
+// Compile-time specialized decoders (see `EncoderBase`).
+// `Derived` must provide `decompressFirstInner` and `nextNonFirst` templated by `CHECK_END`:
+// with `CHECK_END == false` the series is known to go on, so end markers are not looked for.
+// `Derived` may also provide `decodeRun(out)`, which decodes the run of the cheapest entities
+// at the reader position (a bit each) into `out` at once and returns its length, possibly zero.
+template<typename Derived, BitReaderLike Reader, typename T>
+class DecoderBase {
+public:
+    explicit DecoderBase(Reader &br) : br_(br) {}
+
+    std::optional<T> decompressFirst() {
+        auto res = self().decompressFirstInner();
+        if (res) {
+            first_decompressed_ = true;
+        } else {
+            finished_ = true;
+        }
+        return res;
+    }
+
+    std::optional<T> next() {
+        if (!first_decompressed_) {
+            return decompressFirst();
+        }
+        T entity;
+        if (finished_ || !self().nextNonFirst(entity)) {
+            finished_ = true;
+            return std::nullopt;
+        }
+        return entity;
+    }
+
+    // Decode up to `out.size()` entities into `out`.
+    // Returns the number of written entities, which is less than `out.size()` only when
+    // the end of the series is met.
+    size_t decodeInto(std::span<T> out) {
+        size_t n = 0;
+        if (finished_ || out.empty()) {
+            return 0;
+        }
+        if (!first_decompressed_) {
+            auto entity = decompressFirst();
+            if (!entity) {
+                return 0;
+            }
+            out[n++] = *entity;
+        }
+        while (n < out.size()) {
+            if constexpr (HAS_RUNS) {
+                n += self().decodeRun(out.subspan(n));
+                if (n == out.size()) {
+                    break;
+                }
+            }
+            if (!self().nextNonFirst(out[n])) {
+                finished_ = true;
+                break;
+            }
+            n++;
+        }
+        return n;
+    }
+
+    // Decode the next `out.size()` entities of a series ended with `EncoderBase::finishCounted`,
+    // which must have at least that many entities left.
+    void decodeCounted(std::span<T> out) {
+        size_t n = 0;
+        if (!first_decompressed_ && !out.empty()) {
+            out[n++] = *self().template decompressFirstInner<false>();
+            first_decompressed_ = true;
+        }
+        while (n < out.size()) {
+            if constexpr (HAS_RUNS) {
+                n += self().decodeRun(out.subspan(n));
+                if (n == out.size()) {
+                    break;
+                }
+            }
+            self().template nextNonFirst<false>(out[n++]);
+        }
+    }
+
+    [[nodiscard]] bool firstDecompressed() const {
+        return first_decompressed_;
+    }
+
+protected:
+    static constexpr bool HAS_RUNS = requires(Derived d, std::span<T> out) { d.decodeRun(out); };
+
+    Derived &self() {
+        return static_cast<Derived &>(*this);
+    }
+
+    Reader &br_;
+    bool first_decompressed_ = false;
+    // Whether the end of the series was met.
+    bool finished_ = false;
+};
+
+template<BitReaderLike Reader = BitReader>
+class TimestampsDecoder : public DecoderBase<TimestampsDecoder<Reader>, Reader, uint64_t> {
+    using Base = DecoderBase<TimestampsDecoder<Reader>, Reader, uint64_t>;
+    using Base::br_;
+    using Base::first_decompressed_;
+    using Base::finished_;
+
+public:
+    explicit TimestampsDecoder(Reader &br, const TimestampsScale &scale = {}) : Base(br), scale_(scale) {}
+
+    // Header in the scaled units.
+    [[nodiscard]] uint64_t getHeader() const {
+        return header_;
+    }
+
+    // State after the last decoded timestamp (in the scaled units), which is enough to continue
+    // decoding the series from the next bit (see `restore`).
+    struct State {
+        uint64_t header = 0;
+        uint64_t t = 0;
+        int64_t t_delta = 0;
+    };
+
+    [[nodiscard]] State state() const {
+        return {header_, t_, t_delta_};
+    }
+
+    // Continue the series which has `state` after the timestamp preceding the reader position.
+    void restore(const State &state) {
+        header_ = state.header;
+        t_ = state.t;
+        t_delta_ = state.t_delta;
+        first_decompressed_ = true;
+    }
+
+    template<bool CHECK_END = true>
+    std::optional<uint64_t> decompressFirstInner() {
+        header_ = br_.readBits(64);
+        uint64_t delta_u64 = br_.readBits(scale_.first_delta_bits);
+        int64_t delta = *reinterpret_cast<int64_t *>(&delta_u64);
+
+        if (CHECK_END && delta_u64 == (UINT64_MAX >> (64 - scale_.first_delta_bits))) {
+            return std::nullopt;
+        }
+
+        t_delta_ = delta;
+        t_ = header_ + t_delta_;
+        return {scale_.unscaled(t_)};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(uint64_t &t) {
+        auto [prefix_bits, n] = DOD_PREFIXES[br_.peekBits(4)];
+        br_.skipBits(prefix_bits);
+
+        if (n == 0) {
+            t_ += t_delta_;
+            t = scale_.unscaled(t_);
+            return true;
+        }
+
+        uint64_t bits = br_.readBits(n);
+
+        if (CHECK_END && n == 64 && bits == 0xFFFFFFFFFFFFFFFF) {
+            return false;
+        }
+
+        int64_t bits_int64 = *reinterpret_cast<int64_t *>(&bits);
+        int64_t dod = bits_int64;
+        if (n != 64 && (1 << (n - 1)) < bits_int64) {
+            dod = bits_int64 - (1 << n);
+        }
+
+        t_delta_ += dod;
+        t_ += t_delta_;
+        t = scale_.unscaled(t_);
+        return true;
+    }
+
+    // Zero deltas of deltas take a bit each, so a run of them (e.g. of regular timestamps) is found
+    // with a single peek and filled arithmetically.
+    size_t decodeRun(std::span<uint64_t> out) {
+        constexpr int PEEK_BITS = 56;
+        auto zeros = static_cast<size_t>(std::countl_zero(br_.peekBits(PEEK_BITS) << (64 - PEEK_BITS)));
+        size_t run = std::min({zeros, static_cast<size_t>(PEEK_BITS), out.size()});
+        if (run == 0) {
+            return 0;
+        }
+        br_.skipBits(run);
+        for (size_t i = 0; i < run; i++) {
+            t_ += t_delta_;
+            out[i] = scale_.unscaled(t_);
+        }
+        return run;
+    }
+
+private:
+    // Control bits prefix of the delta of deltas indexed by the next 4 bits of the stream:
+    // {number of prefix bits, number of dod bits following the prefix}.
+    //   0    -> dod == 0
+    //   10   -> 7 bits
+    //   110  -> 9 bits
+    //   1110 -> 12 bits
+    //   1111 -> 64 bits
+    static constexpr std::pair<int, int> DOD_PREFIXES[16] = {
+            {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0},
+            {2, 7}, {2, 7}, {2, 7}, {2, 7},
+            {3, 9}, {3, 9},
+            {4, 12},
+            {4, 64},
+    };
+
+    TimestampsScale scale_;
+    uint64_t header_ = 0;
+    uint64_t t_ = 0;
+    int64_t t_delta_ = 0;
+};
+
+template<BitReaderLike Reader = BitReader, std::unsigned_integral V = uint64_t>
+class ValuesDecoder : public DecoderBase<ValuesDecoder<Reader, V>, Reader, V> {
+    using Base = DecoderBase<ValuesDecoder<Reader, V>, Reader, V>;
+    using Base::br_;
+    using Base::first_decompressed_;
+    using Base::finished_;
+
+public:
+    static constexpr int VALUE_BITS = sizeof(V) * 8;
+
+    explicit ValuesDecoder(Reader &br) : Base(br) {}
+
+    // State after the last decoded value (see `TimestampsDecoder::State`).
+    struct State {
+        V value = 0;
+        uint8_t leading_zeros = 0;
+        uint8_t trailing_zeros = 0;
+    };
+
+    [[nodiscard]] State state() const {
+        return {value_, leading_zeros_, trailing_zeros_};
+    }
+
+    void restore(const State &state) {
+        value_ = state.value;
+        leading_zeros_ = state.leading_zeros;
+        trailing_zeros_ = state.trailing_zeros;
+        first_decompressed_ = true;
+    }
+
+    template<bool CHECK_END = true>
+    std::optional<V> decompressFirstInner() {
+        V value = br_.readBits(VALUE_BITS);
+
+        if (CHECK_END && value == std::numeric_limits<V>::max()) {
+            return std::nullopt;
+        }
+
+        value_ = value;
+        return {value};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(V &v) {
+        // 0  -> same value
+        // 10 -> meaningful bits fit the previous window
+        // 11 -> new window
+        uint64_t control = br_.peekBits(2);
+        if (control < 0x2) {
+            br_.skipBits(1);
+            v = value_;
+            return true;
+        }
+        br_.skipBits(2);
+
+        if (control == 0x3) {
+            uint64_t window = br_.readBits(12);
+            uint8_t leading_zeroes = window >> 6;
+            uint8_t significant_bits = window & 0x3F;
+
+            if (CHECK_END && leading_zeroes == 0x3F && significant_bits == 0x3F) {
+                return false;
+            }
+
+            if (significant_bits == 0) {
+                significant_bits = VALUE_BITS;
+            }
+            leading_zeros_ = leading_zeroes;
+            trailing_zeros_ = VALUE_BITS - significant_bits - leading_zeros_;
+        }
+
+        uint64_t value_bits = br_.readBits(VALUE_BITS - leading_zeros_ - trailing_zeros_);
+        value_bits <<= trailing_zeros_;
+        value_ ^= static_cast<V>(value_bits);
+        v = value_;
+        return true;
+    }
+
+private:
+    uint8_t leading_zeros_ = 0;
+    uint8_t trailing_zeros_ = 0;
+    V value_ = 0;
+};
+
+// Decoder of `ChimpEncoder` streams.
+template<BitReaderLike Reader = BitReader>
+class ChimpDecoder : public DecoderBase<ChimpDecoder<Reader>, Reader, uint64_t> {
+    using Base = DecoderBase<ChimpDecoder<Reader>, Reader, uint64_t>;
+    using Base::br_;
+
+public:
+    explicit ChimpDecoder(Reader &br) : Base(br) {}
+
+    template<bool CHECK_END = true>
+    std::optional<uint64_t> decompressFirstInner() {
+        if (!br_.readBit()) {
+            return std::nullopt;
+        }
+        value_ = br_.readBits(64);
+        return {value_};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(uint64_t &v) {
+        switch (br_.readBits(2)) {
+            case 0b00:
+                break;
+            case 0b01: {
+                uint64_t window = br_.readBits(9);
+                uint8_t leading_zeros = CHIMP_LEADING_BUCKETS[window >> 6];
+                int significant_bits = static_cast<int>(window & 0x3F);
+                if (CHECK_END && significant_bits == 0) {
+                    return false;
+                }
+                value_ ^= br_.readBits(significant_bits) << (64 - leading_zeros - significant_bits);
+                break;
+            }
+            case 0b10:
+                value_ ^= br_.readBits(64 - leading_zeros_);
+                break;
+            default:
+                leading_zeros_ = CHIMP_LEADING_BUCKETS[br_.readBits(3)];
+                value_ ^= br_.readBits(64 - leading_zeros_);
+        }
+        v = value_;
+        return true;
+    }
+
+private:
+    uint8_t leading_zeros_ = 0;
+    uint64_t value_ = 0;
+};
+
+// Decoder of `Chimp128Encoder` streams.
+template<BitReaderLike Reader = BitReader>
+class Chimp128Decoder : public DecoderBase<Chimp128Decoder<Reader>, Reader, uint64_t> {
+    using Base = DecoderBase<Chimp128Decoder<Reader>, Reader, uint64_t>;
+    using Base::br_;
+
+public:
+    explicit Chimp128Decoder(Reader &br) : Base(br) {}
+
+    template<bool CHECK_END = true>
+    std::optional<uint64_t> decompressFirstInner() {
+        if (!br_.readBit()) {
+            return std::nullopt;
+        }
+        uint64_t value = br_.readBits(64);
+        store(value);
+        return {value};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(uint64_t &v) {
+        uint64_t value = values_[(index_ - 1) % CHIMP128_PREVIOUS_VALUES];
+        switch (br_.readBits(2)) {
+            case 0b00:
+                value = values_[br_.readBits(CHIMP128_INDEX_BITS)];
+                break;
+            case 0b01: {
+                uint64_t window = br_.readBits(CHIMP128_INDEX_BITS + 3 + 6);
+                uint8_t leading_zeros = CHIMP_LEADING_BUCKETS[(window >> 6) & 0x7];
+                int significant_bits = static_cast<int>(window & 0x3F);
+                if (CHECK_END && significant_bits == 0) {
+                    return false;
+                }
+                value = values_[window >> 9]
+                        ^ (br_.readBits(significant_bits) << (64 - leading_zeros - significant_bits));
+                break;
+            }
+            case 0b10:
+                value ^= br_.readBits(64 - leading_zeros_);
+                break;
+            default:
+                leading_zeros_ = CHIMP_LEADING_BUCKETS[br_.readBits(3)];
+                value ^= br_.readBits(64 - leading_zeros_);
+        }
+        store(value);
+        v = value;
+        return true;
+    }
+
+private:
+    void store(uint64_t v) {
+        values_[index_ % CHIMP128_PREVIOUS_VALUES] = v;
+        index_++;
+    }
+
+    uint8_t leading_zeros_ = 0;
+    std::array<uint64_t, CHIMP128_PREVIOUS_VALUES> values_{};
+    uint64_t index_ = 0;
+};
+
+// Kernels decoding `IntegerEncoder` miniblocks, with SSE4.2, AVX2 and AVX-512 versions picked
+// at runtime by the CPU (see `activeIntegerKernels`), so one binary runs on any x86-64 CPU and
+// uses the widest instructions it has. Vector versions match the scalar ones bit for bit.
+//
+// `unpack(in, n, width, out)` unpacks `n` values of `width` (1..64) bits each packed by `packBits`,
+// `in` must have `INTEGER_PACKED_PADDING` readable bytes past the packed data.
+// `prefix_sum(base, values, n)` turns `n` unpacked values of a miniblock into values in place:
+// `values[0]` is the first value, `values[i]` is the packed delta of the value `i`.
+struct IntegerKernels {
+    void (*unpack)(const uint8_t *in, size_t n, int width, uint64_t *out);
+    void (*prefix_sum)(uint64_t base, uint64_t *values, size_t n);
+};
+
+// Instruction sets the kernels are specialized for, from the narrowest.
+enum class SimdLevel : uint8_t {
+    SCALAR = 0,
+    SSE42 = 1,
+    AVX2 = 2,
+    AVX512 = 3,
+};
+
+// Unpack the values from `from` to `n` (exclusive).
+void unpackBitsRange(const uint8_t *in, size_t from, size_t n, int width, uint64_t *out) {
+    uint64_t mask = width == 64 ? UINT64_MAX : (uint64_t(1) << width) - 1;
+    size_t bit = from * width;
+    for (size_t i = from; i < n; i++, bit += width) {
+        const uint8_t *p = in + bit / 8;
+        int shift = static_cast<int>(bit % 8);
+        uint64_t u = readLittleEndian<uint64_t>(p) >> shift;
+        if (shift + width > 64) {
+            u |= static_cast<uint64_t>(p[8]) << (64 - shift);
+        }
+        out[i] = u & mask;
+    }
+}
+
+void unpackBitsScalar(const uint8_t *in, size_t n, int width, uint64_t *out) {
+    unpackBitsRange(in, 0, n, width, out);
+}
+
+void integerPrefixSumScalar(uint64_t base, uint64_t *values, size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        values[i] = values[i - 1] + zigzagDecode(values[i] + base);
+    }
+}
+
+// Widest value the vector kernels unpack with a single unaligned 64-bit load (shifted by up to 7 bits).
+constexpr int SIMD_UNPACK_MAX_WIDTH = 56;
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GORILLA_X86_SIMD 1
+
+// Intrinsics are used only in the functions compiled for the matching instruction set below.
+
+__attribute__((target("sse4.2")))
+void unpackBitsSse42(const uint8_t *in, size_t n, int width, uint64_t *out) {
+    if (width > SIMD_UNPACK_MAX_WIDTH) {
+        unpackBitsScalar(in, n, width, out);
+        return;
+    }
+    const __m128i mask = _mm_set1_epi64x(static_cast<int64_t>((uint64_t(1) << width) - 1));
+    size_t i = 0;
+    size_t bit = 0;
+    for (; i + 2 <= n; i += 2, bit += 2 * width) {
+        size_t bit1 = bit + width;
+        uint64_t u0, u1;
+        std::memcpy(&u0, in + bit / 8, sizeof(u0));
+        std::memcpy(&u1, in + bit1 / 8, sizeof(u1));
+        __m128i v = _mm_set_epi64x(static_cast<int64_t>(u1), static_cast<int64_t>(u0));
+        __m128i lo = _mm_srl_epi64(v, _mm_cvtsi32_si128(static_cast<int>(bit % 8)));
+        __m128i hi = _mm_srl_epi64(v, _mm_cvtsi32_si128(static_cast<int>(bit1 % 8)));
+        v = _mm_blend_epi16(lo, hi, 0xF0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_and_si128(v, mask));
+    }
+    unpackBitsRange(in, i, n, width, out);
+}
+
+__attribute__((target("sse4.2")))
+void integerPrefixSumSse42(uint64_t base, uint64_t *values, size_t n) {
+    if (n < 2) {
+        return;
+    }
+    const __m128i one = _mm_set1_epi64x(1);
+    const __m128i bases = _mm_set1_epi64x(static_cast<int64_t>(base));
+    __m128i carry = _mm_set1_epi64x(static_cast<int64_t>(values[0]));
+    size_t i = 1;
+    for (; i + 2 <= n; i += 2) {
+        __m128i x = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)), bases);
+        x = _mm_xor_si128(_mm_srli_epi64(x, 1), _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, one)));
+        x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi64(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), x);
+        carry = _mm_unpackhi_epi64(x, x);
+    }
+    integerPrefixSumScalar(base, values + i - 1, n - i + 1);
+}
+
+__attribute__((target("avx2")))
+void unpackBitsAvx2(const uint8_t *in, size_t n, int width, uint64_t *out) {
+    if (width > SIMD_UNPACK_MAX_WIDTH) {
+        unpackBitsScalar(in, n, width, out);
+        return;
+    }
+    const __m256i mask = _mm256_set1_epi64x(static_cast<int64_t>((uint64_t(1) << width) - 1));
+    const __m256i seven = _mm256_set1_epi64x(7);
+    const __m256i step = _mm256_set1_epi64x(4 * width);
+    __m256i bits = _mm256_set_epi64x(3 * width, 2 * width, width, 0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(in), _mm256_srli_epi64(bits, 3), 1);
+        v = _mm256_srlv_epi64(v, _mm256_and_si256(bits, seven));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_and_si256(v, mask));
+        bits = _mm256_add_epi64(bits, step);
+    }
+    unpackBitsRange(in, i, n, width, out);
+}
+
+__attribute__((target("avx2")))
+void integerPrefixSumAvx2(uint64_t base, uint64_t *values, size_t n) {
+    if (n < 2) {
+        return;
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i bases = _mm256_set1_epi64x(static_cast<int64_t>(base));
+    __m256i carry = _mm256_set1_epi64x(static_cast<int64_t>(values[0]));
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)), bases);
+        x = _mm256_xor_si256(_mm256_srli_epi64(x, 1), _mm256_sub_epi64(zero, _mm256_and_si256(x, one)));
+        // Inclusive scan of 4 lanes: add the lanes shifted by 1, then by 2.
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x90), zero, 0x03));
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x40), zero, 0x0F));
+        x = _mm256_add_epi64(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), x);
+        carry = _mm256_permute4x64_epi64(x, 0xFF);
+    }
+    integerPrefixSumScalar(base, values + i - 1, n - i + 1);
+}
+
+__attribute__((target("avx512f")))
+void unpackBitsAvx512(const uint8_t *in, size_t n, int width, uint64_t *out) {
+    if (width > SIMD_UNPACK_MAX_WIDTH) {
+        unpackBitsScalar(in, n, width, out);
+        return;
+    }
+    // Masked forms with all lanes set and a zeroed source: the unmasked intrinsics of GCC 12 take
+    // an undefined source vector, which is reported as maybe uninitialized.
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask = _mm512_set1_epi64(static_cast<int64_t>((uint64_t(1) << width) - 1));
+    const __m512i seven = _mm512_set1_epi64(7);
+    const __m512i step = _mm512_set1_epi64(8 * width);
+    __m512i bits = _mm512_set_epi64(7 * width, 6 * width, 5 * width, 4 * width, 3 * width, 2 * width, width, 0);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_mask_i64gather_epi64(zero, 0xFF, _mm512_maskz_srli_epi64(0xFF, bits, 3), in, 1);
+        v = _mm512_maskz_srlv_epi64(0xFF, v, _mm512_and_si512(bits, seven));
+        _mm512_storeu_si512(out + i, _mm512_and_si512(v, mask));
+        bits = _mm512_add_epi64(bits, step);
+    }
+    unpackBitsRange(in, i, n, width, out);
+}
+
+__attribute__((target("avx512f")))
+void integerPrefixSumAvx512(uint64_t base, uint64_t *values, size_t n) {
+    if (n < 2) {
+        return;
+    }
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i bases = _mm512_set1_epi64(static_cast<int64_t>(base));
+    const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+    const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+    const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+    const __m512i last = _mm512_set1_epi64(7);
+    __m512i carry = _mm512_set1_epi64(static_cast<int64_t>(values[0]));
+    size_t i = 1;
+    for (; i + 8 <= n; i += 8) {
+        __m512i x = _mm512_add_epi64(_mm512_loadu_si512(values + i), bases);
+        // Masked forms as in `unpackBitsAvx512`.
+        x = _mm512_xor_si512(_mm512_maskz_srli_epi64(0xFF, x, 1), _mm512_sub_epi64(zero, _mm512_and_si512(x, one)));
+        // Inclusive scan of 8 lanes: add the lanes shifted by 1, 2 and 4.
+        x = _mm512_add_epi64(x, _mm512_maskz_permutexvar_epi64(0xFE, shift1, x));
+        x = _mm512_add_epi64(x, _mm512_maskz_permutexvar_epi64(0xFC, shift2, x));
+        x = _mm512_add_epi64(x, _mm512_maskz_permutexvar_epi64(0xF0, shift4, x));
+        x = _mm512_add_epi64(x, carry);
+        _mm512_storeu_si512(values + i, x);
+        carry = _mm512_maskz_permutexvar_epi64(0xFF, last, x);
+    }
+    integerPrefixSumScalar(base, values + i - 1, n - i + 1);
+}
+#endif
+
+// Widest instruction set of the CPU the kernels are specialized for (checked with CPUID).
+SimdLevel detectSimdLevel() {
+#ifdef GORILLA_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return SimdLevel::SSE42;
+    }
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Kernels of `level` (scalar ones if they're not compiled in), the CPU must support `level`.
+IntegerKernels integerKernels(SimdLevel level) {
+#ifdef GORILLA_X86_SIMD
+    switch (level) {
+        case SimdLevel::AVX512:
+            return {unpackBitsAvx512, integerPrefixSumAvx512};
+        case SimdLevel::AVX2:
+            return {unpackBitsAvx2, integerPrefixSumAvx2};
+        case SimdLevel::SSE42:
+            return {unpackBitsSse42, integerPrefixSumSse42};
+        default:
+            break;
+    }
+#endif
+    return {unpackBitsScalar, integerPrefixSumScalar};
+}
+
+// Kernels of the widest instruction set of the CPU, detected once.
+const IntegerKernels &activeIntegerKernels() {
+    static const IntegerKernels kernels = integerKernels(detectSimdLevel());
+    return kernels;
+}
+
+// Unpack `n` values of `width` bits each packed by `packBits` (see `IntegerKernels`).
+void unpackBits(const uint8_t *in, size_t n, int width, uint64_t *out) {
+    if (width == 0) {
+        std::fill_n(out, n, 0);
+        return;
+    }
+    activeIntegerKernels().unpack(in, n, width, out);
+}
+
+// Turn `n` unpacked values of an `IntegerEncoder` miniblock into values in place (see `IntegerKernels`).
+void integerPrefixSum(uint64_t base, uint64_t *values, size_t n) {
+    activeIntegerKernels().prefix_sum(base, values, n);
+}
+
+// Add `base` to `n` unpacked values of a plain mode miniblock of `IntegerEncoder` in place.
+void integerAddBase(uint64_t base, uint64_t *values, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        values[i] += base;
+    }
+}
+
+// Decoder of `IntegerEncoder` streams, decoding a whole miniblock at once.
+template<BitReaderLike Reader = BitReader>
+class IntegerDecoder : public DecoderBase<IntegerDecoder<Reader>, Reader, uint64_t> {
+    using Base = DecoderBase<IntegerDecoder<Reader>, Reader, uint64_t>;
+    using Base::br_;
+
+public:
+    explicit IntegerDecoder(Reader &br) : Base(br) {}
+
+    template<bool CHECK_END = true>
+    std::optional<uint64_t> decompressFirstInner() {
+        uint64_t v;
+        if (!nextNonFirst<CHECK_END>(v)) {
+            return std::nullopt;
+        }
+        return {v};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(uint64_t &v) {
+        // Checked per miniblock, so it's kept regardless of `CHECK_END`.
+        if (pos_ == size_ && !loadMiniblock()) {
+            return false;
+        }
+        v = values_[pos_++];
+        return true;
+    }
+
+private:
+    bool loadMiniblock() {
+        auto mode_and_width = static_cast<uint8_t>(br_.readBits(8));
+        int width = mode_and_width & ~INTEGER_PLAIN_MODE;
+        if (mode_and_width == INTEGER_END_MARKER || width > 64) {
+            return false;
+        }
+        size_ = br_.readBits(8) + 1;
+        if (size_ > INTEGER_MINIBLOCK_SIZE) {
+            size_ = 0;
+            return false;
+        }
+        values_[0] = readU64();
+        uint64_t base = readU64();
+        size_t bytes = ((size_ - 1) * width + 7) / 8;
+        size_t i = 0;
+        for (; i + 7 <= bytes; i += 7) {
+            uint64_t u = br_.readBits(56);
+            for (size_t k = 0; k < 7; k++) {
+                packed_[i + k] = static_cast<uint8_t>(u >> (48 - 8 * k));
+            }
+        }
+        for (; i < bytes; i++) {
+            packed_[i] = static_cast<uint8_t>(br_.readBits(8));
+        }
+        unpackBits(packed_.data(), size_ - 1, width, values_.data() + 1);
+        if (mode_and_width & INTEGER_PLAIN_MODE) {
+            integerAddBase(base, values_.data() + 1, size_ - 1);
+        } else {
+            integerPrefixSum(base, values_.data(), size_);
+        }
+        pos_ = 0;
+        return true;
+    }
+
+    // Read a little-endian u64.
+    uint64_t readU64() {
+        return __builtin_bswap64(br_.readBits(64));
+    }
+
+    std::array<uint8_t, INTEGER_MINIBLOCK_SIZE * 8 + INTEGER_PACKED_PADDING> packed_{};
+    // Values of the current miniblock and the next one to return.
+    std::array<uint64_t, INTEGER_MINIBLOCK_SIZE> values_;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+};
+
+template<BitReaderLike Reader = BitReader, std::unsigned_integral V = uint64_t>
+class PairsDecoder : public DecoderBase<PairsDecoder<Reader, V>, Reader, std::pair<uint64_t, V>> {
+    using Base = DecoderBase<PairsDecoder<Reader, V>, Reader, std::pair<uint64_t, V>>;
+    using Base::first_decompressed_;
+    using Base::finished_;
+
+public:
+    explicit PairsDecoder(Reader &br, const TimestampsScale &scale = {})
+            : Base(br), decoder_ts_(br, scale), decoder_value_(br) {}
+
+    [[nodiscard]] uint64_t getHeader() const {
+        return decoder_ts_.getHeader();
+    }
+
+    // State after the last decoded pair (see `TimestampsDecoder::State`).
+    struct State {
+        typename TimestampsDecoder<Reader>::State ts;
+        typename ValuesDecoder<Reader, V>::State value;
+    };
+
+    [[nodiscard]] State state() const {
+        return {decoder_ts_.state(), decoder_value_.state()};
+    }
+
+    void restore(const State &state) {
+        decoder_ts_.restore(state.ts);
+        decoder_value_.restore(state.value);
+        first_decompressed_ = true;
+    }
+
+    template<bool CHECK_END = true>
+    std::optional<std::pair<uint64_t, V>> decompressFirstInner() {
+        auto t = decoder_ts_.template decompressFirstInner<CHECK_END>();
+        if (!t) {
+            return std::nullopt;
+        }
+        auto v = decoder_value_.template decompressFirstInner<CHECK_END>();
+        if (!v) {
+            return std::nullopt;
+        }
+
+        return {std::make_pair(*t, *v)};
+    }
+
+    // Returns false when the end of the series is met.
+    template<bool CHECK_END = true>
+    bool nextNonFirst(std::pair<uint64_t, V> &pair) {
+        return decoder_ts_.template nextNonFirst<CHECK_END>(pair.first)
+               && decoder_value_.template nextNonFirst<CHECK_END>(pair.second);
+    }
+
+    // Decode up to `min(ts.size(), vs.size())` pairs into `ts` and `vs`.
+    // Returns the number of written pairs, which is less than requested only when
+    // the end of the series is met.
+    size_t decodeInto(std::span<uint64_t> ts, std::span<V> vs) {
+        size_t size = std::min(ts.size(), vs.size());
+        size_t n = 0;
+        if (finished_ || size == 0) {
+            return 0;
+        }
+        if (!first_decompressed_) {
+            auto pair = this->decompressFirst();
+            if (!pair) {
+                return 0;
+            }
+            std::tie(ts[n], vs[n]) = *pair;
+            n++;
+        }
+        while (n < size) {
+            if (!decoder_ts_.nextNonFirst(ts[n]) || !decoder_value_.nextNonFirst(vs[n])) {
+                finished_ = true;
+                break;
+            }
+            n++;
+        }
+        return n;
+    }
+
+    // Decode the next `min(ts.size(), vs.size())` pairs of a series ended with `finishCounted`
+    // (see `DecoderBase::decodeCounted`).
+    void decodeCounted(std::span<uint64_t> ts, std::span<V> vs) {
+        size_t size = std::min(ts.size(), vs.size());
+        size_t n = 0;
+        if (!first_decompressed_ && size > 0) {
+            std::tie(ts[n], vs[n]) = *decompressFirstInner<false>();
+            first_decompressed_ = true;
+            n++;
+        }
+        for (; n < size; n++) {
+            decoder_ts_.template nextNonFirst<false>(ts[n]);
+            decoder_value_.template nextNonFirst<false>(vs[n]);
+        }
+    }
+
+private:
+    TimestampsDecoder<Reader> decoder_ts_;
+    ValuesDecoder<Reader, V> decoder_value_;
+};
+
+// Runtime-polymorphic decompressors interface over the decoders above sharing a `BitReader`.
+template<typename T>
+class DecompressorBase {
+public:
+    explicit DecompressorBase(std::shared_ptr<BitReader> bw) : br_(std::move(bw)), first_decompressed_(false) {}
+
+    virtual ~DecompressorBase() = default;
+
+    std::optional<T> next() {
+        if (first_decompressed_) {
+            return decompressNonFirst();
+        } else {
+            return {decompressFirst() };
+        }
+    }
+
+    std::optional<T> decompressFirst() {
+        auto res = decompressFirstInner();
+        if (res) {
+            first_decompressed_ = true;
+        }
+        return res;
+    }
+
+private:
+    virtual std::optional<T> decompressFirstInner() = 0;
+
+    virtual std::optional<T> decompressNonFirst() = 0;
+
+protected:
+    std::shared_ptr<BitReader> br_;
+    bool first_decompressed_ = true;
+};
+
+// Adapter of `D` decoder to the `DecompressorBase<T>` interface.
+template<typename T, typename D>
+class DecoderDecompressor : public DecompressorBase<T> {
+public:
+    explicit DecoderDecompressor(std::shared_ptr<BitReader> br) : DecompressorBase<T>(std::move(br)),
+                                                                  decoder_(*this->br_) {}
+
+    std::optional<T> decompressFirstInner() override {
+        return decoder_.decompressFirst();
+    }
+
+    std::optional<T> decompressNonFirst() override {
+        return decoder_.next();
+    }
+
+    // Bulk decoding of `D` (`decodeInto(out)`, or `decodeInto(ts, vs)` of the pairs decoder).
+    template<typename... Spans>
+    size_t decodeInto(Spans &&... out) {
+        size_t n = decoder_.decodeInto(std::forward<Spans>(out)...);
+        this->first_decompressed_ = decoder_.firstDecompressed();
+        return n;
+    }
+
+protected:
+    D decoder_;
+};
+
+class TimestampsDecompressor : public DecoderDecompressor<uint64_t, TimestampsDecoder<>> {
+public:
+    explicit TimestampsDecompressor(std::shared_ptr<BitReader> br) : DecoderDecompressor(std::move(br)) {}
+
+    [[nodiscard]] uint64_t getHeader() const {
+        return decoder_.getHeader();
+    }
+
+    bool nextNonFirst(uint64_t &t) {
+        return decoder_.nextNonFirst(t);
+    }
+};
+
+class ValuesDecompressor : public DecoderDecompressor<uint64_t, ValuesDecoder<>> {
+public:
+    explicit ValuesDecompressor(std::shared_ptr<BitReader> br) : DecoderDecompressor(std::move(br)) {}
+
+    bool nextNonFirst(uint64_t &v) {
+        return decoder_.nextNonFirst(v);
+    }
+};
+
+class ChimpDecompressor : public DecoderDecompressor<uint64_t, ChimpDecoder<>> {
+public:
+    explicit ChimpDecompressor(std::shared_ptr<BitReader> br) : DecoderDecompressor(std::move(br)) {}
+};
+
+class Chimp128Decompressor : public DecoderDecompressor<uint64_t, Chimp128Decoder<>> {
+public:
+    explicit Chimp128Decompressor(std::shared_ptr<BitReader> br) : DecoderDecompressor(std::move(br)) {}
+};
+
+class IntegerDecompressor : public DecoderDecompressor<uint64_t, IntegerDecoder<>> {
+public:
+    explicit IntegerDecompressor(std::shared_ptr<BitReader> br) : DecoderDecompressor(std::move(br)) {}
+};
+
+// Call `func` with the decoder of `codec` reading from `br` (see `withValuesEncoder`).
+template<typename F>
+decltype(auto) withValuesDecoder(ValuesCodec codec, BitReader &br, F &&func) {
+    switch (codec) {
+        case ValuesCodec::CHIMP: {
+            ChimpDecoder d(br);
+            return func(d);
+        }
+        case ValuesCodec::CHIMP128: {
+            Chimp128Decoder d(br);
+            return func(d);
+        }
+        case ValuesCodec::INTEGER: {
+            IntegerDecoder d(br);
+            return func(d);
+        }
+        default: {
+            ValuesDecoder d(br);
+            return func(d);
+        }
+    }
+}
+
+class PairsDecompressor : public DecoderDecompressor<std::pair<uint64_t, uint64_t>, PairsDecoder<>> {
+public:
+    explicit PairsDecompressor(const std::shared_ptr<BitReader> &br) : DecoderDecompressor(br) {}
+
+    [[nodiscard]] uint64_t getHeader() const {
+        return decoder_.getHeader();
+    }
+};
+// ---------- DECOMPRESSION ----------------
+
+
+// ---------- BLOCKS -----------------------
+// Block-structured container of (time, value) pairs:
+//
+// [block 0][block 1]...[block N-1][footer entry 0]...[footer entry N-1][N: u32][BLOCKS_MAGIC: u32]
+//
+// Every block is an independent `PairsEncoder` stream (starting with its own header and ending
+// with the end marker), so it can be decoded without touching other blocks. Footer entries are
+// `BlockInfo` records written as little-endian integers, they carry the time bounds and the
+// summary of the block values (see `Aggregates`). Blocks are cut every `max_block_points` points
+// or as soon as a block grows over `max_block_bytes` bytes.
+constexpr uint32_t BLOCKS_MAGIC = 0x32425247; // "GRB2"
+constexpr size_t DEFAULT_BLOCK_POINTS = 4096;
+constexpr size_t DEFAULT_BLOCK_BYTES = 64 * 1024;
+
+// Reinterpret a value of the column physical type as `uint64_t` passed to the codecs.
+template<typename CType>
+uint64_t toU64(CType value) {
+    if constexpr (std::is_floating_point_v<CType>) {
+        return std::bit_cast<uint64_t>(value);
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+template<typename CType>
+CType fromU64(uint64_t value) {
+    if constexpr (std::is_floating_point_v<CType>) {
+        return std::bit_cast<CType>(value);
+    } else {
+        return static_cast<CType>(value);
+    }
+}
+
+struct BlockInfo {
+    // Offset of the block from the beginning of the container.
+    uint64_t offset;
+    // Number of points in the block.
+    uint32_t count;
+    // Time bounds of the block (zeros for blocks of a values-only stream).
+    uint64_t min_t;
+    uint64_t max_t;
+    // Summary of the block values as passed to the codecs (zeros for blocks of a timestamps-only stream).
+    uint64_t min_v = 0;
+    uint64_t max_v = 0;
+    uint64_t sum_v = 0;
+    uint64_t first_v = 0;
+    uint64_t last_v = 0;
+
+    static constexpr size_t SERIALIZED_SIZE = 8 + 4 + 7 * 8;
+};
+
+// Aggregates of (time, value) pairs with values of `CType` (one of the column physical types).
+// `first` and `last` are the values at the earliest and the latest time.
+template<typename CType = uint64_t>
+struct Aggregates {
+    // Sum of unsigned values wraps around.
+    using SumType = std::conditional_t<std::is_floating_point_v<CType>, double, uint64_t>;
+
+    uint64_t count = 0;
+    CType min{};
+    CType max{};
+    SumType sum{};
+    uint64_t first_t = 0;
+    CType first{};
+    uint64_t last_t = 0;
+    CType last{};
+
+    void add(uint64_t t, CType v) {
+        if (count == 0) {
+            min = max = first = last = v;
+            first_t = last_t = t;
+        } else {
+            min = std::min(min, v);
+            max = std::max(max, v);
+            if (t < first_t) {
+                first_t = t;
+                first = v;
+            }
+            if (t >= last_t) {
+                last_t = t;
+                last = v;
+            }
+        }
+        sum += v;
+        count++;
+    }
+
+    // Add points of the chunk with `t_from <= t <= t_to`.
+    void addRange(const uint64_t *ts, const uint64_t *vs, size_t n, uint64_t t_from, uint64_t t_to) {
+        for (size_t i = 0; i < n; i++) {
+            if (t_from <= ts[i] && ts[i] <= t_to) {
+                add(ts[i], fromU64<CType>(vs[i]));
+            }
+        }
+    }
+
+    void merge(const Aggregates &other) {
+        if (other.count == 0) {
+            return;
+        }
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        count += other.count;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sum += other.sum;
+        if (other.first_t < first_t) {
+            first_t = other.first_t;
+            first = other.first;
+        }
+        if (other.last_t >= last_t) {
+            last_t = other.last_t;
+            last = other.last;
+        }
+    }
+
+    // Store count, time bounds and the values summary to `block`.
+    void storeTo(BlockInfo &block) const {
+        block.count = static_cast<uint32_t>(count);
+        block.min_t = first_t;
+        block.max_t = last_t;
+        block.min_v = toU64(min);
+        block.max_v = toU64(max);
+        block.sum_v = toU64(sum);
+        block.first_v = toU64(first);
+        block.last_v = toU64(last);
+    }
+
+    static Aggregates fromBlock(const BlockInfo &block) {
+        Aggregates res;
+        res.count = block.count;
+        res.min = fromU64<CType>(block.min_v);
+        res.max = fromU64<CType>(block.max_v);
+        res.sum = fromU64<SumType>(block.sum_v);
+        res.first_t = block.min_t;
+        res.first = fromU64<CType>(block.first_v);
+        res.last_t = block.max_t;
+        res.last = fromU64<CType>(block.last_v);
+        return res;
+    }
+};
+
+// Number of points decoded at once by the aggregate evaluators.
+constexpr size_t AGGREGATE_CHUNK_SIZE = 256;
+
+// Aggregate points with `t_from <= t <= t_to` of a pairs decoder (or decompressor) `d`.
+// The stream is decoded chunk by chunk on the stack, the series is never materialized.
+template<typename CType = uint64_t, typename D>
+Aggregates<CType> aggregatePairs(D &d, uint64_t t_from = 0, uint64_t t_to = UINT64_MAX) {
+    Aggregates<CType> res;
+    uint64_t ts[AGGREGATE_CHUNK_SIZE];
+    uint64_t vs[AGGREGATE_CHUNK_SIZE];
+    size_t decoded;
+    do {
+        decoded = d.decodeInto(std::span(ts), std::span(vs));
+        res.addRange(ts, vs, decoded, t_from, t_to);
+    } while (decoded == AGGREGATE_CHUNK_SIZE);
+    return res;
+}
+
+// Same as `aggregatePairs` for timestamps and values stored as separate streams
+// (decoded in lockstep with `ts_d` and `vs_d` timestamps and values decoders or decompressors).
+template<typename CType = uint64_t, typename TD, typename VD>
+Aggregates<CType> aggregateStreams(TD &ts_d, VD &vs_d, uint64_t t_from = 0, uint64_t t_to = UINT64_MAX) {
+    Aggregates<CType> res;
+    uint64_t ts[AGGREGATE_CHUNK_SIZE];
+    uint64_t vs[AGGREGATE_CHUNK_SIZE];
+    size_t decoded;
+    do {
+        decoded = std::min(ts_d.decodeInto(std::span(ts)), vs_d.decodeInto(std::span(vs)));
+        res.addRange(ts, vs, decoded, t_from, t_to);
+    } while (decoded == AGGREGATE_CHUNK_SIZE);
+    return res;
+}
+
+constexpr size_t blocksFooterSize(size_t block_count) {
+    return block_count * BlockInfo::SERIALIZED_SIZE + 2 * sizeof(uint32_t);
+}
+
+// Write the footer of `blocks` to `out` (at least `blocksFooterSize(blocks.size())` bytes).
+void writeBlocksFooter(uint8_t *out, const std::vector<BlockInfo> &blocks) {
+    for (const auto &block: blocks) {
+        storeLittleEndian(out, block.offset);
+        storeLittleEndian(out + 8, block.count);
+        storeLittleEndian(out + 12, block.min_t);
+        storeLittleEndian(out + 20, block.max_t);
+        storeLittleEndian(out + 28, block.min_v);
+        storeLittleEndian(out + 36, block.max_v);
+        storeLittleEndian(out + 44, block.sum_v);
+        storeLittleEndian(out + 52, block.first_v);
+        storeLittleEndian(out + 60, block.last_v);
+        out += BlockInfo::SERIALIZED_SIZE;
+    }
+    storeLittleEndian(out, static_cast<uint32_t>(blocks.size()));
+    storeLittleEndian(out + sizeof(uint32_t), BLOCKS_MAGIC);
+}
+
+// Values are summarized as `CType` values (see `Aggregates`).
+template<typename CType = uint64_t>
+class BlockPairsWriter {
+public:
+    explicit BlockPairsWriter(size_t max_block_points = DEFAULT_BLOCK_POINTS,
+                              size_t max_block_bytes = DEFAULT_BLOCK_BYTES)
+            : max_block_points_(max_block_points), max_block_bytes_(max_block_bytes) {}
+
+    void append(uint64_t t, uint64_t v) {
+        if (!encoder_) {
+            encoder_.emplace(bw_);
+            blocks_.push_back({bw_.size(), 0, t, t});
+            summary_ = {};
+        }
+        encoder_->compress(std::make_pair(t, v));
+        summary_.add(t, fromU64<CType>(v));
+
+        if (summary_.count == max_block_points_ || bw_.bitSize() / 8 - blocks_.back().offset >= max_block_bytes_) {
+            finishBlock();
+        }
+    }
+
+    // Finish the last block, write the footer and return the container bytes.
+    std::vector<uint8_t> finish() {
+        if (encoder_) {
+            finishBlock();
+        }
+        std::vector<uint8_t> out = bw_.release();
+        size_t blocks_size = out.size();
+        out.resize(blocks_size + blocksFooterSize(blocks_.size()));
+        writeBlocksFooter(out.data() + blocks_size, blocks_);
+        return out;
+    }
+
+private:
+    void finishBlock() {
+        encoder_->finish();
+        encoder_.reset();
+        summary_.storeTo(blocks_.back());
+    }
+
+    size_t max_block_points_;
+    size_t max_block_bytes_;
+    BitWriter bw_;
+    std::optional<PairsEncoder<BitWriter>> encoder_;
+    // Summary of the current block.
+    Aggregates<CType> summary_;
+    std::vector<BlockInfo> blocks_;
+};
+
+// Run `func(i)` for every `i` in `[0, n)` on up to `threads` threads (including the calling one).
+template<typename F>
+void parallelFor(size_t n, size_t threads, F &&func) {
+    threads = std::min(threads, n);
+    if (threads <= 1) {
+        for (size_t i = 0; i < n; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+            func(i);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 0; i + 1 < threads; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &w: workers) {
+        w.join();
+    }
+}
+
+size_t defaultThreadsNumber() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Upper bound of the number of points of a block stored as `block` bytes. Footer counts above it are
+// rejected, so that a corrupted footer can't make readers allocate for more points than the data holds.
+using BlockPointsBound = size_t (*)(std::span<const uint8_t> block);
+
+// Bound of the encoders' streams: every point but the first one takes at least one bit.
+size_t streamBlockPoints(std::span<const uint8_t> block) {
+    return 8 * block.size() + 1;
+}
+
+// Footer index of a blocks container, independent of the kind of blocks' streams.
+class BlocksContainer {
+public:
+    // Container of `data` with a validated footer, `data` must outlive the container.
+    static arrow::Result<BlocksContainer> Make(std::span<const uint8_t> data,
+                                               BlockPointsBound max_block_points = streamBlockPoints) {
+        BlocksContainer container(data);
+        ARROW_RETURN_NOT_OK(container.parseFooter(max_block_points));
+        return container;
+    }
+
+    [[nodiscard]] const std::vector<BlockInfo> &blocks() const {
+        return blocks_;
+    }
+
+    // Total number of points.
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    // Bytes of the `i`-th block.
+    [[nodiscard]] std::span<const uint8_t> blockData(size_t i) const {
+        size_t end = i + 1 < blocks_.size() ? blocks_[i + 1].offset : footer_offset_;
+        return data_.subspan(blocks_[i].offset, end - blocks_[i].offset);
+    }
+
+protected:
+    explicit BlocksContainer(std::span<const uint8_t> data) : data_(data) {}
+
+    arrow::Status parseFooter(BlockPointsBound max_block_points) {
+        size_t trailer_size = blocksFooterSize(0);
+        if (data_.size() < trailer_size
+            || readLittleEndian<uint32_t>(data_.data() + data_.size() - sizeof(uint32_t)) != BLOCKS_MAGIC) {
+            return arrow::Status::SerializationError("Blocks container magic not found.");
+        }
+        size_t block_count = readLittleEndian<uint32_t>(data_.data() + data_.size() - trailer_size);
+        if (block_count > (data_.size() - trailer_size) / BlockInfo::SERIALIZED_SIZE) {
+            return arrow::Status::SerializationError("Blocks container footer is truncated.");
+        }
+        footer_offset_ = data_.size() - blocksFooterSize(block_count);
+
+        blocks_.reserve(block_count);
+        const uint8_t *entry = data_.data() + footer_offset_;
+        for (size_t i = 0; i < block_count; i++, entry += BlockInfo::SERIALIZED_SIZE) {
+            BlockInfo block{
+                    readLittleEndian<uint64_t>(entry),
+                    readLittleEndian<uint32_t>(entry + 8),
+                    readLittleEndian<uint64_t>(entry + 12),
+                    readLittleEndian<uint64_t>(entry + 20),
+                    readLittleEndian<uint64_t>(entry + 28),
+                    readLittleEndian<uint64_t>(entry + 36),
+                    readLittleEndian<uint64_t>(entry + 44),
+                    readLittleEndian<uint64_t>(entry + 52),
+                    readLittleEndian<uint64_t>(entry + 60),
+            };
+            if (block.offset > footer_offset_ || (!blocks_.empty() && block.offset < blocks_.back().offset)) {
+                return arrow::Status::SerializationError("Invalid block offset in blocks container footer.");
+            }
+            time_ordered_ = time_ordered_ && (blocks_.empty() || blocks_.back().max_t <= block.min_t);
+            size_ += block.count;
+            blocks_.push_back(block);
+        }
+        for (size_t i = 0; i < block_count; i++) {
+            if (blocks_[i].count > max_block_points(blockData(i))) {
+                return arrow::Status::SerializationError("Block ", i, " of ", blockData(i).size(),
+                                                         " bytes can't hold ", blocks_[i].count, " points.");
+            }
+        }
+        return arrow::Status::OK();
+    }
+
+    std::span<const uint8_t> data_;
+    std::vector<BlockInfo> blocks_;
+    size_t footer_offset_ = 0;
+    size_t size_ = 0;
+    // Whether every block starts not earlier than the previous one ends.
+    bool time_ordered_ = true;
+};
+
+class BlockPairsReader : public BlocksContainer {
+public:
+    // Reader of `data` with a validated footer, `data` must outlive the reader.
+    // Timestamps of the blocks are encoded with `scale`.
+    static arrow::Result<BlockPairsReader> Make(std::span<const uint8_t> data, const TimestampsScale &scale = {}) {
+        BlockPairsReader reader(data, scale);
+        ARROW_RETURN_NOT_OK(reader.parseFooter(streamBlockPoints));
+        return reader;
+    }
+
+    // Decode all the points of the `i`-th block into `ts` and `vs` (at least `blocks()[i].count` long).
+    size_t decodeBlock(size_t i, std::span<uint64_t> ts, std::span<uint64_t> vs) const {
+        BitReader br(blockData(i));
+        PairsDecoder d(br, scale_);
+        return d.decodeInto(ts.first(blocks_[i].count), vs.first(blocks_[i].count));
+    }
+
+    // Append points with `t_from <= t <= t_to` to `ts` and `vs` decoding only the blocks overlapping
+    // the range. Returns the number of appended points.
+    size_t decodeRange(uint64_t t_from, uint64_t t_to, std::vector<uint64_t> &ts, std::vector<uint64_t> &vs) const {
+        size_t initial_size = ts.size();
+        size_t first_block = 0;
+        if (time_ordered_) {
+            // Blocks don't overlap in time, so the first block ending after `t_from` may be searched.
+            first_block = std::partition_point(blocks_.begin(), blocks_.end(), [t_from](const BlockInfo &block) {
+                return block.max_t < t_from;
+            }) - blocks_.begin();
+        }
+
+        for (size_t i = first_block; i < blocks_.size(); i++) {
+            const auto &block = blocks_[i];
+            if (block.min_t > t_to) {
+                if (time_ordered_) {
+                    break;
+                }
+                continue;
+            }
+            if (block.max_t < t_from) {
+                continue;
+            }
+
+            size_t size = ts.size();
+            ts.resize(size + block.count);
+            vs.resize(size + block.count);
+            size_t decoded = decodeBlock(i, std::span(ts).subspan(size), std::span(vs).subspan(size));
+            size_t end = size + decoded;
+            if (block.min_t < t_from || block.max_t > t_to) {
+                // Block is partially covered by the range, filter out its points in place.
+                size_t kept = size;
+                for (size_t j = size; j < end; j++) {
+                    if (t_from <= ts[j] && ts[j] <= t_to) {
+                        ts[kept] = ts[j];
+                        vs[kept] = vs[j];
+                        kept++;
+                    }
+                }
+                end = kept;
+            }
+            ts.resize(end);
+            vs.resize(end);
+        }
+        return ts.size() - initial_size;
+    }
+
+    // Aggregate points with `t_from <= t <= t_to`. Blocks fully covered by the range are answered
+    // from their stored summary without decoding, only the partially covered ones are decoded.
+    // `CType` must be the one the container was written with.
+    template<typename CType = uint64_t>
+    Aggregates<CType> aggregate(uint64_t t_from = 0, uint64_t t_to = UINT64_MAX) const {
+        Aggregates<CType> res;
+        for (size_t i = 0; i < blocks_.size(); i++) {
+            const auto &block = blocks_[i];
+            if (block.min_t > t_to || block.max_t < t_from) {
+                continue;
+            }
+            if (t_from <= block.min_t && block.max_t <= t_to) {
+                res.merge(Aggregates<CType>::fromBlock(block));
+            } else {
+                BitReader br(blockData(i));
+                PairsDecoder d(br, scale_);
+                res.merge(aggregatePairs<CType>(d, t_from, t_to));
+            }
+        }
+        return res;
+    }
+
+private:
+    BlockPairsReader(std::span<const uint8_t> data, const TimestampsScale &scale)
+            : BlocksContainer(data), scale_(scale) {}
+
+    TimestampsScale scale_;
+};
+
+// Multi-series container: independent `PairsEncoder` streams of many series followed by the series
+// directory sorted by the series key:
+//
+// [series 0]...[series N-1][directory entry 0]...[directory entry N-1][N: u32][SERIES_MAGIC: u32]
+//
+// Every series is ended with `finishCounted`, the entries are `SeriesInfo` records written as
+// little-endian integers, so a series is found by its key and decoded without touching the others.
+constexpr uint32_t SERIES_MAGIC = 0x31535247; // "GRS1"
+
+struct SeriesInfo {
+    uint64_t key;
+    // Offset of the series from the beginning of the container.
+    uint64_t offset;
+    // Number of points in the series.
+    uint64_t count;
+    // Time bounds of the series (zeros for an empty one).
+    uint64_t min_t;
+    uint64_t max_t;
+
+    static constexpr size_t SERIALIZED_SIZE = 5 * 8;
+};
+
+constexpr size_t seriesDirectorySize(size_t series_count) {
+    return series_count * SeriesInfo::SERIALIZED_SIZE + 2 * sizeof(uint32_t);
+}
+
+// Write the directory of `series` (sorted by key) to `out` (at least `seriesDirectorySize(series.size())` bytes).
+void writeSeriesDirectory(uint8_t *out, const std::vector<SeriesInfo> &series) {
+    for (const auto &info: series) {
+        storeLittleEndian(out, info.key);
+        storeLittleEndian(out + 8, info.offset);
+        storeLittleEndian(out + 16, info.count);
+        storeLittleEndian(out + 24, info.min_t);
+        storeLittleEndian(out + 32, info.max_t);
+        out += SeriesInfo::SERIALIZED_SIZE;
+    }
+    storeLittleEndian(out, static_cast<uint32_t>(series.size()));
+    storeLittleEndian(out + sizeof(uint32_t), SERIES_MAGIC);
+}
+
+// Directory of a multi-series container.
+class SeriesContainer {
+public:
+    // Container of `data` with a validated directory, `data` must outlive the container.
+    static arrow::Result<SeriesContainer> Make(std::span<const uint8_t> data) {
+        size_t trailer_size = seriesDirectorySize(0);
+        if (data.size() < trailer_size
+            || readLittleEndian<uint32_t>(data.data() + data.size() - sizeof(uint32_t)) != SERIES_MAGIC) {
+            return arrow::Status::SerializationError("Series container magic not found.");
+        }
+        size_t series_count = readLittleEndian<uint32_t>(data.data() + data.size() - trailer_size);
+        if (series_count > (data.size() - trailer_size) / SeriesInfo::SERIALIZED_SIZE) {
+            return arrow::Status::SerializationError("Series container directory is truncated.");
+        }
+        SeriesContainer container(data);
+        container.directory_offset_ = data.size() - seriesDirectorySize(series_count);
+
+        auto &series = container.series_;
+        series.reserve(series_count);
+        const uint8_t *entry = data.data() + container.directory_offset_;
+        for (size_t i = 0; i < series_count; i++, entry += SeriesInfo::SERIALIZED_SIZE) {
+            SeriesInfo info{
+                    readLittleEndian<uint64_t>(entry),
+                    readLittleEndian<uint64_t>(entry + 8),
+                    readLittleEndian<uint64_t>(entry + 16),
+                    readLittleEndian<uint64_t>(entry + 24),
+                    readLittleEndian<uint64_t>(entry + 32),
+            };
+            if (!series.empty() && info.key <= series.back().key) {
+                return arrow::Status::SerializationError("Series container directory isn't sorted by key.");
+            }
+            if (info.offset > container.directory_offset_
+                || (!series.empty() && info.offset < series.back().offset)) {
+                return arrow::Status::SerializationError("Invalid series offset in series container directory.");
+            }
+            series.push_back(info);
+        }
+        return container;
+    }
+
+    // Series sorted by key.
+    [[nodiscard]] const std::vector<SeriesInfo> &series() const {
+        return series_;
+    }
+
+    // Index of the series with `key` in `series()`.
+    [[nodiscard]] std::optional<size_t> find(uint64_t key) const {
+        auto it = std::lower_bound(series_.begin(), series_.end(), key, [](const SeriesInfo &info, uint64_t key) {
+            return info.key < key;
+        });
+        if (it == series_.end() || it->key != key) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(it - series_.begin());
+    }
+
+    // Bytes of the `i`-th series.
+    [[nodiscard]] std::span<const uint8_t> seriesData(size_t i) const {
+        size_t end = i + 1 < series_.size() ? series_[i + 1].offset : directory_offset_;
+        return data_.subspan(series_[i].offset, end - series_[i].offset);
+    }
+
+private:
+    explicit SeriesContainer(std::span<const uint8_t> data) : data_(data) {}
+
+    std::span<const uint8_t> data_;
+    std::vector<SeriesInfo> series_;
+    size_t directory_offset_ = 0;
+};
+
+// Layout of the pairs stream:
+// * `INTERLEAVED` -- timestamps and values bits follow each other in one stream (`PairsEncoder`);
+// * `SPLIT` -- timestamps and values are encoded into separate sections (`SplitPairsEncoder`).
+enum class PairsLayout {
+    INTERLEAVED,
+    SPLIT,
+};
+
+constexpr size_t SPLIT_PAIRS_HEADER_SIZE = 2 * sizeof(uint64_t);
+
+// Pairs encoder writing the split layout:
+//
+// [u64 timestamps section size][u64 values section size][timestamps stream][values stream]
+//
+// Sizes are in bytes (little-endian). Timestamps may be decoded without touching values and both
+// sections may be decoded in parallel. Sections are buffered until `finish` writes them to `bw`.
+// An empty series is written as two empty sections.
+template<std::unsigned_integral V = uint64_t>
+class SplitPairsEncoder : public EncoderBase<SplitPairsEncoder<V>, BitWriter, std::pair<uint64_t, V>> {
+    using Base = EncoderBase<SplitPairsEncoder<V>, BitWriter, std::pair<uint64_t, V>>;
+
+public:
+    explicit SplitPairsEncoder(BitWriter &bw, const TimestampsScale &scale = {})
+            : Base(bw), encoder_ts_(bw_ts_, scale), encoder_value_(bw_values_) {}
+
+    // Upper bound of the compressed size in bytes of `n` pairs (including `finish`).
+    static constexpr size_t maxCompressedSize(size_t n) {
+        return SPLIT_PAIRS_HEADER_SIZE + PairsEncoder<BitWriter, V>::maxCompressedSize(n);
+    }
+
+    void compressFirstInner(std::pair<uint64_t, V> entity) {
+        auto [t, v] = entity;
+        encoder_ts_.compressFirst(t);
+        encoder_value_.compressFirst(v);
+    }
+
+    void compressNonFirst(std::pair<uint64_t, V> entity) {
+        auto [t, v] = entity;
+        encoder_ts_.compressNonFirst(t);
+        encoder_value_.compressNonFirst(v);
+    }
+
+    // Compress `min(ts.size(), vs.size())` pairs in one loop.
+    void compressBatch(std::span<const uint64_t> ts, std::span<const V> vs) {
+        size_t size = std::min(ts.size(), vs.size());
+        size_t i = 0;
+        if (size > 0 && !this->first_compressed_) {
+            this->compressFirst({ts[0], vs[0]});
+            i++;
+        }
+        for (; i < size; i++) {
+            encoder_ts_.compressNonFirst(ts[i]);
+            encoder_value_.compressNonFirst(vs[i]);
+        }
+    }
+
+    void finish() {
+        if (this->first_compressed_) {
+            encoder_ts_.finish();
+            encoder_value_.finish();
+        }
+        writeSections();
+    }
+
+    // Sections without end markers (see `EncoderBase`).
+    void finishCounted() {
+        encoder_ts_.finishCounted();
+        encoder_value_.finishCounted();
+        writeSections();
+    }
+
+private:
+    void writeSections() {
+        uint8_t header[SPLIT_PAIRS_HEADER_SIZE];
+        storeLittleEndian(header, static_cast<uint64_t>(bw_ts_.size()));
+        storeLittleEndian(header + sizeof(uint64_t), static_cast<uint64_t>(bw_values_.size()));
+        this->bw_.writeBytes(header);
+        this->bw_.writeBytes(std::span(bw_ts_.data(), bw_ts_.size()));
+        this->bw_.writeBytes(std::span(bw_values_.data(), bw_values_.size()));
+    }
+
+    BitWriter bw_ts_;
+    BitWriter bw_values_;
+    TimestampsEncoder<> encoder_ts_;
+    ValuesEncoder<BitWriter, V> encoder_value_;
+};
+
+class SplitPairsCompressor : public EncoderCompressor<std::pair<uint64_t, uint64_t>, SplitPairsEncoder<>> {
+public:
+    explicit SplitPairsCompressor(const std::shared_ptr<BitWriter> &bw) : EncoderCompressor(bw) {}
+
+    void compressBatch(std::span<const uint64_t> ts, std::span<const uint64_t> vs) {
+        encoder_.compressBatch(ts, vs);
+        first_compressed_ = encoder_.firstCompressed();
+    }
+};
+
+// Reader of the split layout written by `SplitPairsEncoder`.
+template<std::unsigned_integral V = uint64_t>
+class SplitPairsDecoder {
+public:
+    // Decoder of `data` with the sections validated against its size, `data` must outlive the decoder.
+    // Timestamps are encoded with `scale`.
+    static arrow::Result<SplitPairsDecoder> Make(std::span<const uint8_t> data, const TimestampsScale &scale = {}) {
+        if (data.size() < SPLIT_PAIRS_HEADER_SIZE) {
+            return arrow::Status::SerializationError("Split pairs data is too short: ", data.size(), " bytes.");
+        }
+        auto ts_size = readLittleEndian<uint64_t>(data.data());
+        auto vs_size = readLittleEndian<uint64_t>(data.data() + sizeof(uint64_t));
+        if (ts_size > data.size() - SPLIT_PAIRS_HEADER_SIZE
+            || vs_size > data.size() - SPLIT_PAIRS_HEADER_SIZE - ts_size) {
+            return arrow::Status::SerializationError("Split pairs sections are out of data bounds.");
+        }
+        return SplitPairsDecoder(data.subspan(SPLIT_PAIRS_HEADER_SIZE, ts_size),
+                                 data.subspan(SPLIT_PAIRS_HEADER_SIZE + ts_size, vs_size), scale);
+    }
+
+    [[nodiscard]] std::span<const uint8_t> timestampsSection() const {
+        return timestamps_;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> valuesSection() const {
+        return values_;
+    }
+
+    // Decode up to `ts.size()` timestamps without touching the values section.
+    size_t decodeTimestampsInto(std::span<uint64_t> ts) const {
+        if (timestamps_.empty()) {
+            return 0;
+        }
+        BitReader br(timestamps_);
+        TimestampsDecoder d(br, scale_);
+        return d.decodeInto(ts);
+    }
+
+    // Decode up to `vs.size()` values without touching the timestamps section.
+    size_t decodeValuesInto(std::span<V> vs) const {
+        if (values_.empty()) {
+            return 0;
+        }
+        BitReader br(values_);
+        ValuesDecoder<BitReader, V> d(br);
+        return d.decodeInto(vs);
+    }
+
+    // Decode up to `min(ts.size(), vs.size())` pairs decoding the sections on up to `threads` threads.
+    size_t decodeInto(std::span<uint64_t> ts, std::span<V> vs, size_t threads = 1) const {
+        size_t size = std::min(ts.size(), vs.size());
+        size_t decoded[2];
+        parallelFor(2, threads, [&](size_t k) {
+            decoded[k] = k == 0 ? decodeTimestampsInto(ts.first(size)) : decodeValuesInto(vs.first(size));
+        });
+        return std::min(decoded[0], decoded[1]);
+    }
+
+private:
+    SplitPairsDecoder(std::span<const uint8_t> timestamps, std::span<const uint8_t> values,
+                      const TimestampsScale &scale) : scale_(scale), timestamps_(timestamps), values_(values) {}
+
+    TimestampsScale scale_;
+    std::span<const uint8_t> timestamps_;
+    std::span<const uint8_t> values_;
+};
+
+// Sidecar index of a `PairsEncoder` stream for random access by row. The stream itself is not changed:
+// after every `points_per_checkpoint` pairs the index keeps the decoder state and the bit offset of the
+// next pair, so decoding of any row resumes from the nearest checkpoint (see `PairsRowReader`).
+// With the default number of points a checkpoint adds about 0.5% to a stream of 1.5 bytes per point.
+// Serialized index is little-endian, the header of the series is written once:
+// [count: u64][points per checkpoint: u64][header: u64] and for every checkpoint
+// [bit offset: u64][t: u64][t delta: u64][value: u64][leading zeros: u8][trailing zeros: u8]
+constexpr size_t DEFAULT_CHECKPOINT_POINTS = 4096;
+constexpr size_t CHECKPOINT_INDEX_HEADER_SIZE = 3 * sizeof(uint64_t);
+constexpr size_t CHECKPOINT_SIZE = 4 * sizeof(uint64_t) + 2;
+
+class PairsCheckpointIndex {
+public:
+    struct Checkpoint {
+        // Offset of the pair following the checkpoint from the beginning of the stream.
+        uint64_t bit_offset = 0;
+        PairsDecoder<>::State state;
+    };
+
+    explicit PairsCheckpointIndex(size_t points_per_checkpoint = DEFAULT_CHECKPOINT_POINTS)
+            : points_per_checkpoint_(std::max<size_t>(points_per_checkpoint, 1)) {}
+
+    // Account a pair just compressed by `encoder` (a `PairsEncoder`), which has written `bit_size`
+    // bits of the stream so far. This way the index is built alongside the stream.
+    template<typename Encoder>
+    void add(const Encoder &encoder, uint64_t bit_size) {
+        count_++;
+        if (count_ % points_per_checkpoint_ != 0) {
+            return;
+        }
+        auto state = encoder.state();
+        // Encoder without a window yet has `INT8_MAX` leading zeros, the decoder starts with no zeros.
+        if (state.value.leading_zeros >= 64) {
+            state.value.leading_zeros = 0;
+            state.value.trailing_zeros = 0;
+        }
+        checkpoints_.push_back({bit_size, {{state.ts.header, state.ts.t, state.ts.t_delta},
+                                           {state.value.value, state.value.leading_zeros,
+                                            state.value.trailing_zeros}}});
+    }
+
+    // Index of an existing stream built by decoding it once. `count` is the number of pairs of a stream
+    // ended with `finishCounted`, otherwise the stream is decoded up to its end marker.
+    static arrow::Result<PairsCheckpointIndex> build(std::span<const uint8_t> stream, const TimestampsScale &scale = {},
+                                      std::optional<size_t> count = std::nullopt,
+                                      size_t points_per_checkpoint = DEFAULT_CHECKPOINT_POINTS) {
+        PairsCheckpointIndex index(points_per_checkpoint);
+        size_t chunk = index.points_per_checkpoint_;
+        std::vector<uint64_t> ts(chunk);
+        std::vector<uint64_t> vs(chunk);
+        BitReader br(stream);
+        PairsDecoder d(br, scale);
+        while (true) {
+            size_t n;
+            if (count) {
+                n = std::min(chunk, *count - index.count_);
+                d.decodeCounted(std::span(ts).first(n), std::span(vs).first(n));
+            } else {
+                n = d.decodeInto(ts, vs);
+            }
+            index.count_ += n;
+            if (br.pastEnd()) {
+                return arrow::Status::SerializationError("Pairs stream of ", stream.size(),
+                                                         " bytes ends before its last pair.");
+            }
+            if (n < chunk) {
+                break;
+            }
+            index.checkpoints_.push_back({br.bitPosition(), d.state()});
+        }
+        return index;
+    }
+
+    [[nodiscard]] std::vector<uint8_t> serialize() const {
+        std::vector<uint8_t> data(CHECKPOINT_INDEX_HEADER_SIZE + checkpoints_.size() * CHECKPOINT_SIZE);
+        storeLittleEndian(data.data(), static_cast<uint64_t>(count_));
+        storeLittleEndian(data.data() + 8, static_cast<uint64_t>(points_per_checkpoint_));
+        storeLittleEndian(data.data() + 16, checkpoints_.empty() ? uint64_t(0) : checkpoints_[0].state.ts.header);
+        uint8_t *p = data.data() + CHECKPOINT_INDEX_HEADER_SIZE;
+        for (const auto &checkpoint: checkpoints_) {
+            storeLittleEndian(p, checkpoint.bit_offset);
+            storeLittleEndian(p + 8, checkpoint.state.ts.t);
+            storeLittleEndian(p + 16, static_cast<uint64_t>(checkpoint.state.ts.t_delta));
+            storeLittleEndian(p + 24, checkpoint.state.value.value);
+            p[32] = checkpoint.state.value.leading_zeros;
+            p[33] = checkpoint.state.value.trailing_zeros;
+            p += CHECKPOINT_SIZE;
+        }
+        return data;
+    }
+
+    // Index serialized with `serialize`, which may be stale or corrupt as it's stored aside of the stream.
+    static arrow::Result<PairsCheckpointIndex> parse(std::span<const uint8_t> data) {
+        if (data.size() < CHECKPOINT_INDEX_HEADER_SIZE
+            || (data.size() - CHECKPOINT_INDEX_HEADER_SIZE) % CHECKPOINT_SIZE != 0) {
+            return arrow::Status::SerializationError("Checkpoint index has invalid size: ", data.size(), " bytes.");
+        }
+        auto count = readLittleEndian<uint64_t>(data.data());
+        auto points_per_checkpoint = readLittleEndian<uint64_t>(data.data() + 8);
+        auto header = readLittleEndian<uint64_t>(data.data() + 16);
+        size_t checkpoints = (data.size() - CHECKPOINT_INDEX_HEADER_SIZE) / CHECKPOINT_SIZE;
+        if (points_per_checkpoint == 0 || count / points_per_checkpoint != checkpoints) {
+            return arrow::Status::SerializationError("Checkpoint index has ", checkpoints, " checkpoints for ", count,
+                                                     " points.");
+        }
+        PairsCheckpointIndex index(points_per_checkpoint);
+        index.count_ = count;
+        const uint8_t *p = data.data() + CHECKPOINT_INDEX_HEADER_SIZE;
+        for (size_t k = 0; k < checkpoints; k++, p += CHECKPOINT_SIZE) {
+            Checkpoint checkpoint;
+            checkpoint.bit_offset = readLittleEndian<uint64_t>(p);
+            checkpoint.state.ts = {header, readLittleEndian<uint64_t>(p + 8),
+                                   static_cast<int64_t>(readLittleEndian<uint64_t>(p + 16))};
+            checkpoint.state.value = {readLittleEndian<uint64_t>(p + 24), p[32], p[33]};
+            if (checkpoint.state.value.leading_zeros + checkpoint.state.value.trailing_zeros >= 64
+                || (k > 0 && checkpoint.bit_offset < index.checkpoints_.back().bit_offset)) {
+                return arrow::Status::SerializationError("Invalid checkpoint ", k, " in checkpoint index.");
+            }
+            index.checkpoints_.push_back(checkpoint);
+        }
+        return index;
+    }
+
+    // Number of indexed pairs.
+    [[nodiscard]] size_t count() const {
+        return count_;
+    }
+
+    [[nodiscard]] size_t pointsPerCheckpoint() const {
+        return points_per_checkpoint_;
+    }
+
+    // Checkpoint `k` precedes row `(k + 1) * pointsPerCheckpoint()`.
+    [[nodiscard]] const std::vector<Checkpoint> &checkpoints() const {
+        return checkpoints_;
+    }
+
+private:
+    size_t points_per_checkpoint_;
+    size_t count_ = 0;
+    std::vector<Checkpoint> checkpoints_;
+};
+
+// Reader of a `PairsEncoder` stream by row with its `PairsCheckpointIndex`: `seekToRow` restores
+// the decoder from the nearest checkpoint before the row and decodes less than `pointsPerCheckpoint()`
+// pairs up to it, so a lookup costs O(`pointsPerCheckpoint()`). `stream` and `index` must outlive the reader.
+class PairsRowReader {
+public:
+    PairsRowReader(std::span<const uint8_t> stream, const PairsCheckpointIndex &index,
+                   const TimestampsScale &scale = {}) : stream_(stream), index_(index), scale_(scale) {}
+
+    PairsRowReader(const PairsRowReader &) = delete;
+
+    PairsRowReader &operator=(const PairsRowReader &) = delete;
+
+    // Position the reader at row `row`. Returns false when the stream has no such row.
+    bool seekToRow(size_t row) {
+        decoder_.reset();
+        br_.reset();
+        if (row >= index_.count()) {
+            return false;
+        }
+        size_t k = row / index_.pointsPerCheckpoint();
+        if (k == 0) {
+            br_.emplace(stream_);
+            decoder_.emplace(*br_, scale_);
+        } else {
+            const auto &checkpoint = index_.checkpoints()[k - 1];
+            if (checkpoint.bit_offset > stream_.size() * 8) {
+                return false;
+            }
+            br_.emplace(stream_.subspan(checkpoint.bit_offset / 8));
+            br_->skipBits(checkpoint.bit_offset % 8);
+            decoder_.emplace(*br_, scale_);
+            decoder_->restore(checkpoint.state);
+        }
+        row_ = k * index_.pointsPerCheckpoint();
+        uint64_t t, v;
+        while (row_ < row) {
+            decodeInto({&t, 1}, {&v, 1});
+        }
+        return true;
+    }
+
+    // Decode up to `min(ts.size(), vs.size())` pairs from the current row into `ts` and `vs`.
+    // Returns the number of decoded pairs, which is less than requested only at the end of the stream.
+    size_t decodeInto(std::span<uint64_t> ts, std::span<uint64_t> vs) {
+        if (!decoder_) {
+            return 0;
+        }
+        size_t n = std::min({ts.size(), vs.size(), index_.count() - row_});
+        decoder_->decodeCounted(ts.first(n), vs.first(n));
+        row_ += n;
+        return n;
+    }
+
+    std::optional<std::pair<uint64_t, uint64_t>> next() {
+        uint64_t t, v;
+        if (decodeInto({&t, 1}, {&v, 1}) == 0) {
+            return std::nullopt;
+        }
+        return {std::make_pair(t, v)};
+    }
+
+    // Row of the next decoded pair.
+    [[nodiscard]] size_t row() const {
+        return row_;
+    }
+
+private:
+    std::span<const uint8_t> stream_;
+    const PairsCheckpointIndex &index_;
+    TimestampsScale scale_;
+    std::optional<BitReader> br_;
+    std::optional<PairsDecoder<>> decoder_;
+    size_t row_ = 0;
+};
+
+// Codec of a block of a single column stream, written as the first byte of the block:
+// * `GORILLA` -- `TimestampsEncoder` or `ValuesEncoder` stream;
+// * `DELTA` -- first value (64 bits), width `w` (7 bits) and zigzag deltas of `w` bits each;
+// * `RLE` -- runs of equal values as the value (64 bits) and the run length (32 bits);
+// * `RAW` -- values of 64 bits each;
+// * `GORILLA_LZ4`, `GORILLA_ZSTD` -- size of the Gorilla stream (u32, little-endian) and the stream
+//   compressed with a general-purpose codec (see `serializeSingleColumnBatchAdaptive`);
+// * `REGULAR` -- first value and step (64 bits each) of values with equal deltas, e.g. scraped
+//   timestamps. Decoding is an arithmetic fill and any value is found in O(1) (see `regularBlockValue`).
+// Number of values of a block is taken from the footer of the container.
+enum class BlockCodec : uint8_t {
+    GORILLA = 0,
+    DELTA = 1,
+    RLE = 2,
+    RAW = 3,
+    GORILLA_LZ4 = 4,
+    GORILLA_ZSTD = 5,
+    REGULAR = 6,
+};
+
+// Width in bits of the widest zigzag delta of `values`.
+int deltaBlockWidth(std::span<const uint64_t> values) {
+    uint64_t zigzags = 0;
+    for (size_t i = 1; i < values.size(); i++) {
+        zigzags |= zigzagEncode(values[i] - values[i - 1]);
+    }
+    return 64 - std::countl_zero(zigzags);
+}
+
+// Sizes in bytes (including the codec byte) of `values` encoded with the codecs which size is
+// computed exactly in one pass. `regular` is `SIZE_MAX` when the deltas of `values` differ.
+struct BlockCodecSizes {
+    size_t delta;
+    size_t rle;
+    size_t raw;
+    size_t regular;
+};
+
+BlockCodecSizes blockCodecSizes(std::span<const uint64_t> values) {
+    if (values.empty()) {
+        return {1, 1, 1, 1 + 16};
+    }
+    uint64_t zigzags = 0;
+    size_t runs = 1;
+    bool regular = true;
+    for (size_t i = 1; i < values.size(); i++) {
+        zigzags |= zigzagEncode(values[i] - values[i - 1]);
+        runs += values[i] != values[i - 1];
+        regular &= values[i] - values[i - 1] == values[1] - values[0];
+    }
+    int width = 64 - std::countl_zero(zigzags);
+    return {
+            1 + (64 + 7 + (values.size() - 1) * width + 7) / 8,
+            1 + runs * (64 + 32) / 8,
+            1 + values.size() * 8,
+            regular ? 1 + 16 : SIZE_MAX,
+    };
+}
+
+void encodeDeltaBlock(std::span<const uint64_t> values, BitWriter &bw) {
+    int width = deltaBlockWidth(values);
+    bw.writeBits(values[0], 64);
+    bw.writeBits(width, 7);
+    for (size_t i = 1; i < values.size(); i++) {
+        bw.writeBits(zigzagEncode(values[i] - values[i - 1]), width);
+    }
+    bw.flush(false);
+}
+
+void encodeRleBlock(std::span<const uint64_t> values, BitWriter &bw) {
+    for (size_t i = 0; i < values.size();) {
+        size_t run_end = i + 1;
+        while (run_end < values.size() && values[run_end] == values[i]) {
+            run_end++;
+        }
+        bw.writeBits(values[i], 64);
+        bw.writeBits(run_end - i, 32);
+        i = run_end;
+    }
+}
+
+void encodeRawBlock(std::span<const uint64_t> values, BitWriter &bw) {
+    for (auto value: values) {
+        bw.writeBits(value, 64);
+    }
+}
+
+// `values` must have equal deltas (see `BlockCodecSizes::regular`).
+void encodeRegularBlock(std::span<const uint64_t> values, BitWriter &bw) {
+    bw.writeBits(values.empty() ? 0 : values[0], 64);
+    bw.writeBits(values.size() < 2 ? 0 : values[1] - values[0], 64);
+}
+
+// Decoders of the blocks above fill the whole `out` and return the number of decoded values
+// (less than `out.size()` only for corrupted data).
+size_t decodeDeltaBlock(std::span<const uint8_t> data, std::span<uint64_t> out) {
+    if (out.empty()) {
+        return 0;
+    }
+    BitReader br(data);
+    out[0] = br.readBits(64);
+    int width = static_cast<int>(br.readBits(7));
+    if (width > 64) {
+        return 0;
+    }
+    for (size_t i = 1; i < out.size(); i++) {
+        out[i] = out[i - 1] + zigzagDecode(br.readBits(width));
+    }
+    return out.size();
+}
+
+size_t decodeRleBlock(std::span<const uint8_t> data, std::span<uint64_t> out) {
+    BitReader br(data);
+    size_t n = 0;
+    while (n < out.size()) {
+        uint64_t value = br.readBits(64);
+        size_t run = std::min<size_t>(br.readBits(32), out.size() - n);
+        if (run == 0) {
+            break;
+        }
+        std::fill_n(out.begin() + n, run, value);
+        n += run;
+    }
+    return n;
+}
+
+size_t decodeRawBlock(std::span<const uint8_t> data, std::span<uint64_t> out) {
+    size_t n = std::min(out.size(), data.size() / 8);
+    BitReader br(data);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = br.readBits(64);
+    }
+    return n;
+}
+
+size_t decodeRegularBlock(std::span<const uint8_t> data, std::span<uint64_t> out) {
+    if (data.size() < 16) {
+        return 0;
+    }
+    BitReader br(data);
+    uint64_t start = br.readBits(64);
+    uint64_t step = br.readBits(64);
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = start + i * step;
+    }
+    return out.size();
+}
+
+// Value number `i` of a `REGULAR` block (without the codec byte).
+uint64_t regularBlockValue(std::span<const uint8_t> data, size_t i) {
+    BitReader br(data);
+    uint64_t start = br.readBits(64);
+    return start + i * br.readBits(64);
+}
+
+// Maximum number of points of an adaptive block. `DELTA`, `RLE`, `REGULAR` and the general-purpose
+// compressed blocks may hold any number of points in a few bytes, so their footer counts are capped.
+constexpr size_t MAX_ADAPTIVE_BLOCK_POINTS = 1 << 20;
+
+// `BlockPointsBound` of the blocks above (with the codec byte).
+size_t adaptiveBlockPoints(std::span<const uint8_t> block) {
+    if (block.empty()) {
+        return 0;
+    }
+    switch (static_cast<BlockCodec>(block[0])) {
+        case BlockCodec::GORILLA:
+            return streamBlockPoints(block.subspan(1));
+        case BlockCodec::RAW:
+            return (block.size() - 1) / 8;
+        default:
+            return MAX_ADAPTIVE_BLOCK_POINTS;
+    }
+}
+// ---------- BLOCKS -----------------------
+
+
+
+// ---------- STORE ------------------------
+// In-memory time series store in the spirit of Facebook's Beringei
+// (https://github.com/facebookarchive/beringei/blob/master/beringei/lib/BucketMap.cpp).
+//
+// Every series has an open block of the current 2-hour window (see `getHeaderFromTimestamp`) appended
+// to with `PairsEncoder`, and immutable sealed blocks of the previous windows. The open block is sealed
+// when a point of a later window comes or by `sealBefore`. Blocks are ended with `finishCounted` and
+// decoded by the number of their points with `decodeCounted`.
+//
+// Series are spread over shards by id and every shard is guarded by its own reader-writer lock
+// (lock striping), so appends to different shards and all the queries run in parallel.
+constexpr size_t DEFAULT_STORE_SHARDS = 256;
+
+class TimeSeriesStore {
+public:
+    // Timestamps of all the series are encoded with `scale` (seconds by default).
+    explicit TimeSeriesStore(const TimestampsScale &scale = {}, size_t shards = DEFAULT_STORE_SHARDS)
+            : scale_(scale), shards_(std::max<size_t>(shards, 1)) {}
+
+    TimeSeriesStore(const TimeSeriesStore &) = delete;
+
+    TimeSeriesStore &operator=(const TimeSeriesStore &) = delete;
+
+    // Append point (`t`, `v`) to series `id`. Points of a series must come in non-decreasing time order,
+    // older ones are dropped (false is returned).
+    bool append(uint64_t id, uint64_t t, uint64_t v) {
+        auto &shard = shardOf(id);
+        std::unique_lock lock(shard.mutex);
+        return seriesOf(shard, id).append(t, v, scale_);
+    }
+
+    // Append `min(ts.size(), vs.size())` points to series `id` under one lock (see `append`).
+    // Returns the number of appended points.
+    size_t appendBatch(uint64_t id, std::span<const uint64_t> ts, std::span<const uint64_t> vs) {
+        auto &shard = shardOf(id);
+        std::unique_lock lock(shard.mutex);
+        auto &series = seriesOf(shard, id);
+        size_t appended = 0;
+        for (size_t i = 0; i < std::min(ts.size(), vs.size()); i++) {
+            appended += series.append(ts[i], vs[i], scale_);
+        }
+        return appended;
+    }
+
+    // Append points of series `id` with `from <= t <= to` to `ts` and `vs` in time order.
+    // Returns the number of appended points.
+    size_t query(uint64_t id, uint64_t from, uint64_t to, std::vector<uint64_t> &ts, std::vector<uint64_t> &vs) const {
+        auto &shard = shardOf(id);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.series.find(id);
+        if (it == shard.series.end()) {
+            return 0;
+        }
+        size_t size = ts.size();
+        it->second->query(from, to, scale_, ts, vs);
+        return ts.size() - size;
+    }
+
+    // Seal the open blocks of the windows ending not later than `t` (e.g. of the series which stopped
+    // receiving points). Returns the number of sealed blocks.
+    size_t sealBefore(uint64_t t) {
+        size_t sealed = 0;
+        for (auto &shard: shards_) {
+            std::unique_lock lock(shard.mutex);
+            for (auto &[id, series]: shard.series) {
+                sealed += series->sealBefore(t, scale_);
+            }
+        }
+        return sealed;
+    }
+
+    struct Stats {
+        size_t series = 0;
+        size_t points = 0;
+        // Size of the compressed blocks.
+        size_t bytes = 0;
+        // Memory of the per-series bookkeeping: the series with their encoders, the nodes and buckets of
+        // the series maps, the lists of sealed blocks and the unused space of the open blocks' buffers.
+        // Allocator overhead is not included.
+        size_t bookkeeping_bytes = 0;
+    };
+
+    [[nodiscard]] Stats stats() const {
+        Stats stats;
+        for (const auto &shard: shards_) {
+            std::shared_lock lock(shard.mutex);
+            stats.series += shard.series.size();
+            stats.bookkeeping_bytes += shard.series.bucket_count() * sizeof(void *);
+            for (const auto &[id, series]: shard.series) {
+                // Map node is the next node pointer and the key with the series pointer.
+                stats.bookkeeping_bytes += sizeof(Series) + sizeof(void *) + sizeof(uint64_t) + sizeof(series);
+                series->addStats(stats);
+            }
+        }
+        return stats;
+    }
+
+private:
+    struct SealedBlock {
+        // Header of the window in the scaled units.
+        uint64_t header;
+        size_t count;
+        std::vector<uint8_t> data;
+    };
+
+    class Series {
+    public:
+        bool append(uint64_t t, uint64_t v, const TimestampsScale &scale) {
+            if (t < last_t_) {
+                return false;
+            }
+            uint64_t header = getHeaderFromTimestamp(scale.scaled(t), scale.window);
+            if (count_ > 0 && header != header_) {
+                seal();
+            }
+            if (count_ == 0) {
+                header_ = header;
+                encoder_.emplace(bw_, scale);
+            }
+            encoder_->compress({t, v});
+            count_++;
+            last_t_ = t;
+            return true;
+        }
+
+        bool sealBefore(uint64_t t, const TimestampsScale &scale) {
+            if (count_ == 0 || scale.unscaled(header_ + scale.window) > t) {
+                return false;
+            }
+            seal();
+            return true;
+        }
+
+        void query(uint64_t from, uint64_t to, const TimestampsScale &scale,
+                   std::vector<uint64_t> &ts, std::vector<uint64_t> &vs) const {
+            // Window of a block is `[unscaled(header), unscaled(header + window))`.
+            auto overlaps = [&](uint64_t header) {
+                return scale.unscaled(header) <= to && from < scale.unscaled(header + scale.window);
+            };
+            for (const auto &block: sealed_) {
+                if (overlaps(block.header)) {
+                    decodeBlock(block.data, block.count, from, to, scale, ts, vs);
+                }
+            }
+            if (count_ > 0 && overlaps(header_)) {
+                std::vector<uint8_t> data;
+                bw_.copyTo(data);
+                decodeBlock(data, count_, from, to, scale, ts, vs);
+            }
+        }
+
+        void addStats(Stats &stats) const {
+            for (const auto &block: sealed_) {
+                stats.points += block.count;
+                stats.bytes += block.data.size();
+            }
+            stats.points += count_;
+            stats.bytes += (bw_.bitSize() + 7) / 8;
+            stats.bookkeeping_bytes += sealed_.capacity() * sizeof(SealedBlock) + bw_.capacity() - bw_.size();
+        }
+
+    private:
+        void seal() {
+            encoder_->finishCounted();
+            encoder_.reset();
+            auto data = bw_.release();
+            data.shrink_to_fit();
+            sealed_.push_back({header_, count_, std::move(data)});
+            count_ = 0;
+        }
+
+        // Append the points of a block with `from <= t <= to` to `ts` and `vs`.
+        static void decodeBlock(std::span<const uint8_t> data, size_t count, uint64_t from, uint64_t to,
+                                const TimestampsScale &scale, std::vector<uint64_t> &ts, std::vector<uint64_t> &vs) {
+            size_t begin = ts.size();
+            ts.resize(begin + count);
+            vs.resize(begin + count);
+            BitReader br(data);
+            PairsDecoder d(br, scale);
+            d.decodeCounted(std::span(ts).subspan(begin), std::span(vs).subspan(begin));
+            size_t n = begin;
+            for (size_t i = begin; i < begin + count; i++) {
+                if (from <= ts[i] && ts[i] <= to) {
+                    ts[n] = ts[i];
+                    vs[n] = vs[i];
+                    n++;
+                }
+            }
+            ts.resize(n);
+            vs.resize(n);
+        }
+
+        std::vector<SealedBlock> sealed_;
+        // Open block.
+        BitWriter bw_;
+        std::optional<PairsEncoder<>> encoder_;
+        uint64_t header_ = 0;
+        size_t count_ = 0;
+        uint64_t last_t_ = 0;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64_t, std::unique_ptr<Series>> series;
+    };
+
+    [[nodiscard]] size_t shardIndex(uint64_t id) const {
+        return ((id * 0x9E3779B97F4A7C15) >> 32) % shards_.size();
+    }
+
+    Shard &shardOf(uint64_t id) {
+        return shards_[shardIndex(id)];
+    }
+
+    [[nodiscard]] const Shard &shardOf(uint64_t id) const {
+        return shards_[shardIndex(id)];
+    }
+
+    // Series `id` of `shard`, created on the first access (`shard` must be locked exclusively).
+    static Series &seriesOf(Shard &shard, uint64_t id) {
+        auto &series = shard.series[id];
+        if (!series) {
+            series = std::make_unique<Series>();
+        }
+        return *series;
+    }
+
+    TimestampsScale scale_;
+    std::vector<Shard> shards_;
+};
+
+// Pairs stream open for appends by a single writer and for reads by any number of concurrent readers.
+//
+// The writer encodes pairs with `PairsEncoder` into 64-bit words, which are never changed once
+// written. After every append it publishes a snapshot of the stream: the number of pairs, the number
+// of whole bytes written and the bits still pending in the writer. Snapshots are published under a
+// sequence lock, so the writer doesn't wait for the readers, and a reader only retries while a
+// snapshot is being published. When the buffer is full, the writer continues in a twice larger copy
+// and publishes it as well. A reader takes a reference to the published buffer while copying from it
+// (under a mutex the writer only takes when the buffer grows), so an old buffer is freed as soon as
+// the last reader of it is done.
+class OpenPairsStream {
+public:
+    // Timestamps are encoded with `scale` (seconds by default).
+    explicit OpenPairsStream(const TimestampsScale &scale = {}) : scale_(scale), encoder_(sink_, scale) {}
+
+    OpenPairsStream(const OpenPairsStream &) = delete;
+
+    OpenPairsStream &operator=(const OpenPairsStream &) = delete;
+
+    // Append a pair and publish it (the writer side, must not be called concurrently).
+    void append(uint64_t t, uint64_t v) {
+        encoder_.compress({t, v});
+        count_++;
+        publish();
+    }
+
+    // Append `min(ts.size(), vs.size())` pairs and publish them at once.
+    void appendBatch(std::span<const uint64_t> ts, std::span<const uint64_t> vs) {
+        encoder_.compressBatch(ts, vs);
+        count_ += std::min(ts.size(), vs.size());
+        publish();
+    }
+
+    // Consistent state of the stream taken by a reader: the encoded pairs as the stream is ended
+    // with `finishCounted` and their number.
+    struct Snapshot {
+        std::vector<uint8_t> data;
+        size_t count = 0;
+    };
+
+    [[nodiscard]] Snapshot snapshot() const {
+        size_t bytes;
+        uint64_t tail;
+        int tail_bits;
+        Snapshot snapshot;
+        while (true) {
+            uint64_t sequence = sequence_.load(std::memory_order_acquire);
+            if (sequence % 2 == 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            bytes = published_bytes_.load(std::memory_order_relaxed);
+            tail = published_tail_.load(std::memory_order_relaxed);
+            tail_bits = published_tail_bits_.load(std::memory_order_relaxed);
+            snapshot.count = published_count_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+        // The buffer is published before the snapshot, so it's the one of the snapshot or a later copy.
+        // Either way it holds the whole bytes of the snapshot, which are never changed by the writer.
+        std::shared_ptr<const uint8_t[]> buffer;
+        {
+            std::lock_guard lock(buffer_mutex_);
+            buffer = published_buffer_;
+        }
+        snapshot.data.reserve(bytes + sizeof(uint64_t));
+        snapshot.data.insert(snapshot.data.end(), buffer.get(), buffer.get() + bytes);
+        for (int bits = 0; bits < tail_bits; bits += 8) {
+            snapshot.data.push_back(static_cast<uint8_t>(tail >> (56 - bits)));
+        }
+        return snapshot;
+    }
+
+    // Append the pairs of a snapshot of the stream to `ts` and `vs`, returns the number of appended pairs.
+    size_t read(std::vector<uint64_t> &ts, std::vector<uint64_t> &vs) const {
+        auto snapshot = this->snapshot();
+        size_t begin = ts.size();
+        ts.resize(begin + snapshot.count);
+        vs.resize(begin + snapshot.count);
+        BitReader br(snapshot.data);
+        PairsDecoder d(br, scale_);
+        d.decodeCounted(std::span(ts).subspan(begin), std::span(vs).subspan(begin));
+        return snapshot.count;
+    }
+
+private:
+    // Bit sink of the encoder writing whole words into the buffer.
+    class Sink {
+    public:
+        void writeBit(bool bit) {
+            acc_.writeBit(bit, [this](uint64_t word) {
+                emitWord(word);
+            });
+        }
+
+        void writeBits(uint64_t u64, int nbits) {
+            acc_.writeBits(u64, nbits, [this](uint64_t word) {
+                emitWord(word);
+            });
+        }
+
+        // The stream is never ended, the padding bits are written for the interface only.
+        void flush(bool bit) {
+            writeBits(bit ? 0xFF : 0x00, (8 - acc_.bits % 8) % 8);
+        }
+
+    private:
+        friend class OpenPairsStream;
+
+        void emitWord(uint64_t word) {
+            if (size_ + sizeof(uint64_t) > capacity_) {
+                size_t capacity = std::max<size_t>(capacity_ * 2, 256);
+                auto buffer = std::make_shared_for_overwrite<uint8_t[]>(capacity);
+                if (size_ > 0) {
+                    std::memcpy(buffer.get(), buffer_.get(), size_);
+                }
+                buffer_ = std::move(buffer);
+                capacity_ = capacity;
+            }
+            if constexpr (std::endian::native == std::endian::little) {
+                word = __builtin_bswap64(word);
+            }
+            std::memcpy(buffer_.get() + size_, &word, sizeof(word));
+            size_ += sizeof(uint64_t);
+        }
+
+        // Current buffer, the previous ones are owned by the readers still copying from them.
+        std::shared_ptr<uint8_t[]> buffer_;
+        size_t size_ = 0;
+        size_t capacity_ = 0;
+        BitAccumulator acc_;
+    };
+
+    void publish() {
+        if (published_buffer_.get() != sink_.buffer_.get()) {
+            std::lock_guard lock(buffer_mutex_);
+            published_buffer_ = sink_.buffer_;
+        }
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        published_bytes_.store(sink_.size_, std::memory_order_relaxed);
+        published_tail_.store(sink_.acc_.word, std::memory_order_relaxed);
+        published_tail_bits_.store(sink_.acc_.bits, std::memory_order_relaxed);
+        published_count_.store(count_, std::memory_order_relaxed);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    TimestampsScale scale_;
+    Sink sink_;
+    PairsEncoder<Sink> encoder_;
+    size_t count_ = 0;
+
+    // Buffer of the stream, replaced only when it grows (read without the lock by the writer only).
+    mutable std::mutex buffer_mutex_;
+    std::shared_ptr<const uint8_t[]> published_buffer_;
+    // Snapshot published by the writer, odd `sequence_` while it's being changed.
+    std::atomic<uint64_t> sequence_ = 0;
+    std::atomic<size_t> published_bytes_ = 0;
+    std::atomic<uint64_t> published_tail_ = 0;
+    std::atomic<int> published_tail_bits_ = 0;
+    std::atomic<size_t> published_count_ = 0;
+};
+// ---------- STORE ------------------------
+
+
+
+// ---------- APACHE ARROW HELPERS --------------
+// Calls `func(std::type_identity<CType>{})` with the physical C type of one of the column types
+// supported by the codecs. Type dispatch is done once per column.
+template<typename F>
+class ColumnTypeVisitor {
+public:
+    explicit ColumnTypeVisitor(F &func) : func_(func) {}
+
+    arrow::Status Visit(const arrow::UInt64Type &) {
+        return func_(std::type_identity<uint64_t>{});
+    }
+
+    arrow::Status Visit(const arrow::UInt32Type &) {
+        return func_(std::type_identity<uint32_t>{});
+    }
+
+    arrow::Status Visit(const arrow::DoubleType &) {
+        return func_(std::type_identity<double>{});
+    }
+
+    arrow::Status Visit(const arrow::TimestampType &) {
+        return func_(std::type_identity<int64_t>{});
+    }
+
+    arrow::Status Visit(const arrow::DataType &type) {
+        return arrow::Status::TypeError("Unknown column type met for Gorilla serialization: ", type.ToString());
+    }
+
+private:
+    F &func_;
+};
+
+template<typename F>
+arrow::Status visitColumnType(const arrow::DataType &type, F &&func) {
+    ColumnTypeVisitor<F> visitor(func);
+    return arrow::VisitTypeInline(type, &visitor);
+}
+
+// Calls `func(const CType *values, int64_t length)` with the raw values buffer of the column.
+template<typename F>
+arrow::Status visitColumnValues(const arrow::ArrayData &data, F &&func) {
+    return visitColumnType(*data.type, [&data, &func](auto type_tag) {
+        using CType = typename decltype(type_tag)::type;
+        return func(data.GetValues<CType>(1), data.length);
+    });
+}
+
+// Write `<schema length>\n<schema>` followed by the compressed bytes written by `encode_func(BitWriter &)`
+// into one buffer presized with `max_compressed_size` (the upper bound of the compressed size).
+// The buffer is shrunk to fit afterwards.
+template<typename F>
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeWithSchema(
+        const std::shared_ptr<arrow::Schema> &batch_schema,
+        size_t max_compressed_size,
+        F encode_func
+) {
+    ARROW_ASSIGN_OR_RAISE(auto schema_serialized_buffer, arrow::ipc::SerializeSchema(*batch_schema));
+    auto schema_size = static_cast<size_t>(schema_serialized_buffer->size());
+
+    char prefix[std::numeric_limits<size_t>::digits10 + 2];
+    auto prefix_end = std::to_chars(prefix, prefix + sizeof(prefix) - 1, schema_size).ptr;
+    *prefix_end++ = '\n';
+    auto prefix_size = static_cast<size_t>(prefix_end - prefix);
+
+    size_t header_size = prefix_size + schema_size;
+    ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::ResizableBuffer> buffer,
+                          arrow::AllocateResizableBuffer(static_cast<int64_t>(header_size + max_compressed_size)));
+    std::memcpy(buffer->mutable_data(), prefix, prefix_size);
+    std::memcpy(buffer->mutable_data() + prefix_size, schema_serialized_buffer->data(), schema_size);
+
+    BitWriter bw(std::span<uint8_t>(buffer->mutable_data() + header_size, max_compressed_size));
+    ARROW_RETURN_NOT_OK(encode_func(bw));
+    if (bw.overflowed()) {
+        return arrow::Status::SerializationError("Compressed data exceeds the bound of ", max_compressed_size, " bytes");
+    }
+    ARROW_RETURN_NOT_OK(buffer->Resize(static_cast<int64_t>(header_size + bw.size()), true));
+    return {buffer};
+}
+
+// Field metadata key of the values codec tag (absent for `ValuesCodec::GORILLA`).
+const std::string VALUES_CODEC_METADATA_KEY = "gorilla.values_codec";
+
+// Codec of a values column of `type`: `codec` itself unless it's `ValuesCodec::AUTO`, which stands
+// for `INTEGER` on integer columns and `GORILLA` on the rest.
+ValuesCodec resolveValuesCodec(ValuesCodec codec, const arrow::DataType &type) {
+    if (codec != ValuesCodec::AUTO) {
+        return codec;
+    }
+    bool is_integer = type.id() == arrow::Type::UINT64 || type.id() == arrow::Type::UINT32;
+    return is_integer ? ValuesCodec::INTEGER : ValuesCodec::GORILLA;
+}
+
+// Tag the fields of `schema` from `first_values_field` on (the values columns) with the codecs
+// they are encoded with (`codec` resolved per field), which are written into `codecs` by field index.
+std::shared_ptr<arrow::Schema> withValuesCodecTags(
+        const std::shared_ptr<arrow::Schema> &schema,
+        int first_values_field,
+        ValuesCodec codec,
+        std::vector<ValuesCodec> &codecs
+) {
+    codecs.assign(schema->num_fields(), ValuesCodec::GORILLA);
+    arrow::FieldVector fields = schema->fields();
+    for (int i = first_values_field; i < schema->num_fields(); i++) {
+        codecs[i] = resolveValuesCodec(codec, *fields[i]->type());
+        if (codecs[i] == ValuesCodec::GORILLA) {
+            continue;
+        }
+        auto metadata = fields[i]->metadata() ? fields[i]->metadata()->Copy()
+                                              : std::make_shared<arrow::KeyValueMetadata>();
+        metadata->Append(VALUES_CODEC_METADATA_KEY, std::to_string(static_cast<int>(codecs[i])));
+        fields[i] = fields[i]->WithMetadata(metadata);
+    }
+    return arrow::schema(fields, schema->metadata());
+}
+
+// Read the values codec tags of the fields of `schema` and remove them from `schema`.
+arrow::Result<std::vector<ValuesCodec>> takeValuesCodecTags(std::shared_ptr<arrow::Schema> &schema) {
+    std::vector<ValuesCodec> codecs(schema->num_fields(), ValuesCodec::GORILLA);
+    arrow::FieldVector fields = schema->fields();
+    bool tagged = false;
+    for (size_t i = 0; i < fields.size(); i++) {
+        const auto &metadata = fields[i]->metadata();
+        int index = metadata ? metadata->FindKey(VALUES_CODEC_METADATA_KEY) : -1;
+        if (index < 0) {
+            continue;
+        }
+
+        const auto &tag = metadata->value(index);
+        int codec = -1;
+        std::from_chars(tag.data(), tag.data() + tag.size(), codec);
+        if (codec < static_cast<int>(ValuesCodec::GORILLA) || codec > static_cast<int>(ValuesCodec::INTEGER)) {
+            return arrow::Status::SerializationError("Unknown values codec tag: ", tag, ".");
+        }
+        codecs[i] = static_cast<ValuesCodec>(codec);
+
+        auto rest = metadata->Copy();
+        ARROW_RETURN_NOT_OK(rest->Delete(index));
+        fields[i] = rest->size() > 0 ? fields[i]->WithMetadata(rest) : fields[i]->RemoveMetadata();
+        tagged = true;
+    }
+    if (tagged) {
+        schema = arrow::schema(fields, schema->metadata());
+    }
+    return codecs;
+}
+
+// Number of `unit`s in a second.
+uint64_t unitsPerSecond(arrow::TimeUnit::type unit) {
+    switch (unit) {
+        case arrow::TimeUnit::MILLI:
+            return 1000;
+        case arrow::TimeUnit::MICRO:
+            return 1000 * 1000;
+        case arrow::TimeUnit::NANO:
+            return 1000 * 1000 * 1000;
+        default:
+            return 1;
+    }
+}
+
+// Field metadata key of the timestamps scale tag `<step>,<remainder>` (absent for the default scale).
+const std::string TIMESTAMPS_SCALE_METADATA_KEY = "gorilla.timestamps_scale";
+
+// Scale of the timestamps column `data` by its unit and the step of its values (see `TimestampsScale`),
+// the default one for non-timestamp columns. Without `detect_step` only the unit is taken into account,
+// so any other timestamps of the unit fit the scale as well.
+TimestampsScale detectTimestampsScale(const arrow::ArrayData &data, bool detect_step = true) {
+    if (data.type->id() != arrow::Type::TIMESTAMP) {
+        return {};
+    }
+    const auto &type = static_cast<const arrow::TimestampType &>(*data.type);
+    std::span<const uint64_t> ts(reinterpret_cast<const uint64_t *>(data.GetValues<int64_t>(1)),
+                                 static_cast<size_t>(data.length));
+    uint64_t step = detect_step ? detectTimestampsStep(ts) : 1;
+    return TimestampsScale::Make(unitsPerSecond(type.unit()), step, ts.empty() ? 0 : ts[0] % step);
+}
+
+// Tag the timestamps field `field` of `schema` with `scale` the timestamps are encoded with.
+std::shared_ptr<arrow::Schema> withTimestampsScaleTag(
+        const std::shared_ptr<arrow::Schema> &schema,
+        int field,
+        const TimestampsScale &scale
+) {
+    if (scale.isDefault()) {
+        return schema;
+    }
+    arrow::FieldVector fields = schema->fields();
+    auto metadata = fields[field]->metadata() ? fields[field]->metadata()->Copy()
+                                              : std::make_shared<arrow::KeyValueMetadata>();
+    metadata->Append(TIMESTAMPS_SCALE_METADATA_KEY, std::to_string(scale.step) + "," + std::to_string(scale.remainder));
+    fields[field] = fields[field]->WithMetadata(metadata);
+    return arrow::schema(fields, schema->metadata());
+}
+
+// Read the timestamps scale tag of the timestamps field `field` of `schema` and remove it from `schema`.
+// Untagged timestamps are encoded with the default scale.
+arrow::Result<TimestampsScale> takeTimestampsScaleTag(std::shared_ptr<arrow::Schema> &schema, int field) {
+    if (field >= schema->num_fields()) {
+        return TimestampsScale{};
+    }
+    const auto &metadata = schema->field(field)->metadata();
+    int index = metadata ? metadata->FindKey(TIMESTAMPS_SCALE_METADATA_KEY) : -1;
+    if (index < 0) {
+        return TimestampsScale{};
+    }
+    if (schema->field(field)->type()->id() != arrow::Type::TIMESTAMP) {
+        return arrow::Status::SerializationError("Timestamps scale tag on a non-timestamp field ", field, ".");
+    }
+
+    const auto &tag = metadata->value(index);
+    uint64_t step = 0;
+    uint64_t remainder = 0;
+    auto [ptr, ec] = std::from_chars(tag.data(), tag.data() + tag.size(), step);
+    if (ec != std::errc() || ptr == tag.data() + tag.size() || *ptr != ','
+        || std::from_chars(ptr + 1, tag.data() + tag.size(), remainder).ec != std::errc() || step == 0) {
+        return arrow::Status::SerializationError("Invalid timestamps scale tag: ", tag, ".");
+    }
+    const auto &type = static_cast<const arrow::TimestampType &>(*schema->field(field)->type());
+
+    auto rest = metadata->Copy();
+    ARROW_RETURN_NOT_OK(rest->Delete(index));
+    auto untagged = rest->size() > 0 ? schema->field(field)->WithMetadata(rest)
+                                     : schema->field(field)->RemoveMetadata();
+    ARROW_ASSIGN_OR_RAISE(schema, schema->SetField(field, untagged));
+    return TimestampsScale::Make(unitsPerSecond(type.unit()), step, remainder);
+}
+
+// Format of the payload of `serializeSingleColumnBatch` and `serializePairsBatch`:
+// * `END_MARKER` -- streams are ended with the end markers of the encoders (`finish`);
+// * `COUNTED` -- the payload starts with the number of points (u64, little-endian) and streams are
+//   ended with `finishCounted`. The output is allocated once and decoded without per-point end
+//   checks, and values reserved as end markers (e.g. the first value 0xFFFFFFFFFFFFFFFF) may be stored;
+// * `APPENDABLE` -- interleaved pairs only: the series ended with `finishCounted` is followed by
+//   `PairsTrailer`, so new points are appended with `appendTo` without decoding the series.
+//   Timestamps are scaled by their unit only (see `detectTimestampsScale`) to fit any new points.
+// `END_MARKER` is the default: builds before the version tag ignore it and read any payload as an
+// `END_MARKER` one, so the other versions are opt-in once every reader of the data knows the tag.
+enum class FormatVersion : uint8_t {
+    END_MARKER = 1,
+    COUNTED = 2,
+    APPENDABLE = 3,
+};
+
+constexpr size_t POINTS_COUNT_SIZE = sizeof(uint64_t);
+
+// Schema metadata key of the format version tag (absent for `FormatVersion::END_MARKER`).
+const std::string FORMAT_VERSION_METADATA_KEY = "gorilla.format_version";
+
+std::shared_ptr<arrow::Schema> withFormatVersionTag(
+        const std::shared_ptr<arrow::Schema> &schema,
+        FormatVersion version
+) {
+    if (version == FormatVersion::END_MARKER) {
+        return schema;
+    }
+    auto metadata = schema->metadata() ? schema->metadata()->Copy() : std::make_shared<arrow::KeyValueMetadata>();
+    metadata->Append(FORMAT_VERSION_METADATA_KEY, std::to_string(static_cast<int>(version)));
+    return schema->WithMetadata(metadata);
+}
+
+// Read the format version tag of `schema` and remove it from `schema`.
+arrow::Result<FormatVersion> takeFormatVersionTag(std::shared_ptr<arrow::Schema> &schema) {
+    const auto &metadata = schema->metadata();
+    int index = metadata ? metadata->FindKey(FORMAT_VERSION_METADATA_KEY) : -1;
+    if (index < 0) {
+        return FormatVersion::END_MARKER;
+    }
+
+    const auto &tag = metadata->value(index);
+    int version = -1;
+    std::from_chars(tag.data(), tag.data() + tag.size(), version);
+    if (version < static_cast<int>(FormatVersion::COUNTED) || version > static_cast<int>(FormatVersion::APPENDABLE)) {
+        return arrow::Status::SerializationError("Unknown format version tag: ", tag, ".");
+    }
+
+    auto rest = metadata->Copy();
+    ARROW_RETURN_NOT_OK(rest->Delete(index));
+    schema = rest->size() > 0 ? schema->WithMetadata(rest) : schema->RemoveMetadata();
+    return static_cast<FormatVersion>(version);
+}
+
+// Layout of the payload following the schema, i.e. the serializer it's written by:
+// * `STREAMS` -- `serializeSingleColumnBatch` and `serializePairsBatch` with `PairsLayout::INTERLEAVED`;
+// * `SPLIT_PAIRS` -- `serializePairsBatch` with `PairsLayout::SPLIT`;
+// * `COLUMN_SEGMENTS` -- `serializeSingleColumnBatchParallel`;
+// * `PAIRS_SEGMENTS` -- `serializePairsBatchParallel`;
+// * `MULTI_COLUMN` -- `serializeMultiColumnBatch`;
+// * `ADAPTIVE` -- `serializeSingleColumnBatchAdaptive`;
+// * `SERIES` -- `serializeSeriesContainer`.
+// Every deserializer reads only its own layout, so a payload of another serializer is rejected
+// rather than partially decoded.
+enum class BatchLayout : uint8_t {
+    STREAMS = 0,
+    SPLIT_PAIRS = 1,
+    COLUMN_SEGMENTS = 2,
+    PAIRS_SEGMENTS = 3,
+    MULTI_COLUMN = 4,
+    ADAPTIVE = 5,
+    SERIES = 6,
+};
+
+// Schema metadata key of the layout tag (absent for `BatchLayout::STREAMS`, the layout written before the tag).
+const std::string LAYOUT_METADATA_KEY = "gorilla.layout";
+
+std::shared_ptr<arrow::Schema> withLayoutTag(
+        const std::shared_ptr<arrow::Schema> &schema,
+        BatchLayout layout
+) {
+    if (layout == BatchLayout::STREAMS) {
+        return schema;
+    }
+    auto metadata = schema->metadata() ? schema->metadata()->Copy() : std::make_shared<arrow::KeyValueMetadata>();
+    metadata->Append(LAYOUT_METADATA_KEY, std::to_string(static_cast<int>(layout)));
+    return schema->WithMetadata(metadata);
+}
+
+// Read the layout tag of `schema`, check that it's `expected` and remove it from `schema`.
+arrow::Status takeLayoutTag(std::shared_ptr<arrow::Schema> &schema, BatchLayout expected) {
+    const auto &metadata = schema->metadata();
+    int index = metadata ? metadata->FindKey(LAYOUT_METADATA_KEY) : -1;
+    int layout = static_cast<int>(BatchLayout::STREAMS);
+    if (index >= 0) {
+        const auto &tag = metadata->value(index);
+        layout = -1;
+        std::from_chars(tag.data(), tag.data() + tag.size(), layout);
+        if (layout <= static_cast<int>(BatchLayout::STREAMS) || layout > static_cast<int>(BatchLayout::SERIES)) {
+            return arrow::Status::SerializationError("Unknown layout tag: ", tag, ".");
+        }
+    }
+    if (layout != static_cast<int>(expected)) {
+        return arrow::Status::SerializationError("Batch of layout ", layout, " can't be read as layout ",
+                                                 static_cast<int>(expected), ".");
+    }
+    if (index < 0) {
+        return arrow::Status::OK();
+    }
+
+    auto rest = metadata->Copy();
+    ARROW_RETURN_NOT_OK(rest->Delete(index));
+    schema = rest->size() > 0 ? schema->WithMetadata(rest) : schema->RemoveMetadata();
+    return arrow::Status::OK();
+}
+
+void writePointsCount(BitWriter &bw, size_t count) {
+    uint8_t bytes[POINTS_COUNT_SIZE];
+    storeLittleEndian(bytes, static_cast<uint64_t>(count));
+    bw.writeBytes(bytes);
+}
+
+// Split a `FormatVersion::COUNTED` payload into the number of points and the streams.
+arrow::Result<std::pair<size_t, std::span<const uint8_t>>> readPointsCount(std::span<const uint8_t> payload) {
+    if (payload.size() < POINTS_COUNT_SIZE) {
+        return arrow::Status::SerializationError("Payload is too short for the number of points: ",
+                                                 payload.size(), " bytes.");
+    }
+    auto count = readLittleEndian<uint64_t>(payload.data());
+    auto streams = payload.subspan(POINTS_COUNT_SIZE);
+    // Every point but the first takes at least a bit.
+    if (count > 8 * streams.size() + 1) {
+        return arrow::Status::SerializationError("Number of points ", count, " doesn't fit ",
+                                                 streams.size(), " bytes of data.");
+    }
+    return std::make_pair(static_cast<size_t>(count), streams);
+}
+
+// Split a `FormatVersion::APPENDABLE` payload into the trailer and the series.
+arrow::Result<std::pair<PairsTrailer, std::span<const uint8_t>>> readPairsTrailer(std::span<const uint8_t> payload) {
+    if (payload.size() < PAIRS_TRAILER_SIZE) {
+        return arrow::Status::SerializationError("Payload is too short for the pairs trailer: ",
+                                                 payload.size(), " bytes.");
+    }
+    auto stream = payload.first(payload.size() - PAIRS_TRAILER_SIZE);
+    auto trailer = PairsTrailer::read(stream.data() + stream.size());
+    if ((trailer.bit_size + 7) / 8 != stream.size() || trailer.count > trailer.bit_size + 1) {
+        return arrow::Status::SerializationError("Pairs trailer doesn't match ", stream.size(), " bytes of data.");
+    }
+    return std::make_pair(trailer, stream);
+}
+
+// Number of pairs (none for a stream ended with the end marker) and the `PairsEncoder` stream
+// of the payload of a pairs batch serialized with `PairsLayout::INTERLEAVED`.
+arrow::Result<std::pair<std::optional<size_t>, std::span<const uint8_t>>> readPairsStream(
+        std::span<const uint8_t> payload, FormatVersion version) {
+    if (version == FormatVersion::COUNTED) {
+        ARROW_ASSIGN_OR_RAISE(auto count_and_stream, readPointsCount(payload));
+        return std::make_pair(std::optional<size_t>(count_and_stream.first), count_and_stream.second);
+    }
+    if (version == FormatVersion::APPENDABLE) {
+        ARROW_ASSIGN_OR_RAISE(auto trailer_and_stream, readPairsTrailer(payload));
+        return std::make_pair(std::optional<size_t>(trailer_and_stream.first.count), trailer_and_stream.second);
+    }
+    return std::make_pair(std::optional<size_t>(), payload);
+}
+
+// End the series of encoder `c` as `version` stands for.
+template<typename E>
+void finishSeries(E &c, FormatVersion version) {
+    if (version == FormatVersion::END_MARKER) {
+        c.finish();
+    } else {
+        c.finishCounted();
+    }
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeSingleColumnBatchToBuffer(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        ValuesCodec codec = ValuesCodec::AUTO,
+        FormatVersion version = FormatVersion::END_MARKER
+) {
+    if (version == FormatVersion::APPENDABLE) {
+        return arrow::Status::NotImplemented("Appendable format is supported for pairs only.");
+    }
+    auto initial_schema = batch->schema();
+    auto column_type = initial_schema->field(0)->type();
+    bool is_timestamp = column_type->id() == arrow::Type::TIMESTAMP;
+    std::vector<ValuesCodec> codecs;
+    initial_schema = withValuesCodecTags(initial_schema, is_timestamp ? 1 : 0, codec, codecs);
+    codec = codecs[0];
+    TimestampsScale scale;
+    if (is_timestamp) {
+        scale = detectTimestampsScale(*batch->column_data()[0]);
+        initial_schema = withTimestampsScaleTag(initial_schema, 0, scale);
+    }
+
+    initial_schema = withFormatVersionTag(initial_schema, version);
+
+    auto rows = static_cast<size_t>(batch->num_rows());
+    size_t max_compressed_size = POINTS_COUNT_SIZE + (is_timestamp ? TimestampsEncoder<>::maxCompressedSize(rows)
+                                                                   : valuesMaxCompressedSize(codec, rows));
+    return serializeWithSchema(initial_schema, max_compressed_size, [&](BitWriter &bw) {
+        if (version == FormatVersion::COUNTED) {
+            writePointsCount(bw, rows);
+        }
+        return visitColumnValues(*batch->column_data()[0], [&](const auto *values, int64_t length) {
+            if (is_timestamp) {
+                TimestampsEncoder c(bw, scale);
+                for (int64_t i = 0; i < length; i++) {
+                    c.compress(toU64(values[i]));
+                }
+                finishSeries(c, version);
+            } else {
+                withValuesEncoder(codec, bw, [&](auto &c) {
+                    for (int64_t i = 0; i < length; i++) {
+                        c.compress(toU64(values[i]));
+                    }
+                    finishSeries(c, version);
+                });
+            }
+            return arrow::Status::OK();
+        });
+    });
+}
+
+arrow::Result<std::string> serializeSingleColumnBatch(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        ValuesCodec codec = ValuesCodec::AUTO,
+        FormatVersion version = FormatVersion::END_MARKER
+) {
+    ARROW_ASSIGN_OR_RAISE(auto buffer, serializeSingleColumnBatchToBuffer(batch, codec, version));
+    return buffer->ToString();
+}
+
+// Compress the pairs of `batch` with pairs encoder `c`.
+template<typename E>
+arrow::Status compressPairs(const std::shared_ptr<arrow::RecordBatch> &batch, E &c) {
+    const auto &ts_data = *batch->column_data()[0];
+    const auto &vs_data = *batch->column_data()[1];
+    return visitColumnValues(ts_data, [&](const auto *ts, int64_t length) {
+        return visitColumnValues(vs_data, [&](const auto *vs, int64_t) {
+            for (int64_t i = 0; i < length; i++) {
+                c.compress(std::make_pair(toU64(ts[i]), toU64(vs[i])));
             }
+            return arrow::Status::OK();
+        });
+    });
+}
+
+template<typename E>
+arrow::Status encodePairs(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        const TimestampsScale &scale,
+        BitWriter &bw,
+        FormatVersion version
+) {
+    E c(bw, scale);
+    ARROW_RETURN_NOT_OK(compressPairs(batch, c));
+    if constexpr (requires { c.state(); }) {
+        if (version == FormatVersion::APPENDABLE) {
+            PairsTrailer trailer{static_cast<uint64_t>(batch->num_rows()), bw.bitSize(), c.state()};
+            c.finishCounted();
+            trailer.write(bw);
+            return arrow::Status::OK();
+        }
+    }
+    finishSeries(c, version);
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializePairsBatchToBuffer(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        PairsLayout layout = PairsLayout::INTERLEAVED,
+        FormatVersion version = FormatVersion::END_MARKER
+) {
+    bool appendable = version == FormatVersion::APPENDABLE;
+    if (appendable && layout == PairsLayout::SPLIT) {
+        return arrow::Status::NotImplemented("Appendable format is supported for the interleaved layout only.");
+    }
+    auto scale = detectTimestampsScale(*batch->column_data()[0], !appendable);
+    auto initial_schema = withTimestampsScaleTag(batch->schema(), 0, scale);
+    initial_schema = withFormatVersionTag(initial_schema, version);
+    initial_schema = withLayoutTag(initial_schema,
+                                   layout == PairsLayout::SPLIT ? BatchLayout::SPLIT_PAIRS : BatchLayout::STREAMS);
+
+    auto rows = static_cast<size_t>(batch->num_rows());
+    size_t max_compressed_size = POINTS_COUNT_SIZE + PAIRS_TRAILER_SIZE + (layout == PairsLayout::SPLIT
+                                                                           ? SplitPairsEncoder<>::maxCompressedSize(rows)
+                                                                           : PairsEncoder<>::maxCompressedSize(rows));
+    return serializeWithSchema(initial_schema, max_compressed_size, [&](BitWriter &bw) {
+        if (version == FormatVersion::COUNTED) {
+            writePointsCount(bw, rows);
+        }
+        if (layout == PairsLayout::SPLIT) {
+            return encodePairs<SplitPairsEncoder<>>(batch, scale, bw, version);
+        }
+        return encodePairs<PairsEncoder<>>(batch, scale, bw, version);
+    });
+}
+
+arrow::Result<std::string> serializePairsBatch(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        PairsLayout layout = PairsLayout::INTERLEAVED,
+        FormatVersion version = FormatVersion::END_MARKER
+) {
+    ARROW_ASSIGN_OR_RAISE(auto buffer, serializePairsBatchToBuffer(batch, layout, version));
+    return buffer->ToString();
+}
+
+// Number of points per independently encoded segment in the parallel mode.
+constexpr size_t DEFAULT_SEGMENT_POINTS = 64 * 1024;
+
+// Write encoded segments as blocks of a blocks container (see `BlocksContainer`) after the schema.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeSegmentsWithSchema(
+        const std::shared_ptr<arrow::Schema> &batch_schema,
+        const std::vector<BitWriter> &segments,
+        std::vector<BlockInfo> &blocks
+) {
+    size_t max_compressed_size = blocksFooterSize(blocks.size());
+    for (const auto &segment: segments) {
+        max_compressed_size += segment.size();
+    }
+    return serializeWithSchema(batch_schema, max_compressed_size, [&](BitWriter &bw) {
+        for (size_t k = 0; k < segments.size(); k++) {
+            blocks[k].offset = bw.size();
+            bw.writeBytes(std::span(segments[k].data(), segments[k].size()));
+        }
+        std::vector<uint8_t> footer(blocksFooterSize(blocks.size()));
+        writeBlocksFooter(footer.data(), blocks);
+        bw.writeBytes(footer);
+        return arrow::Status::OK();
+    });
+}
+
+// Describe `values` of a standalone stream with `block` (time bounds only for timestamps,
+// values summary only for values).
+template<typename CType>
+void storeColumnSummary(std::span<const CType> values, bool is_timestamp, BlockInfo &block) {
+    block = {0, 0, 0, 0};
+    if (is_timestamp) {
+        Aggregates<uint64_t> summary;
+        for (auto value: values) {
+            summary.add(toU64(value), 0);
+        }
+        block.count = static_cast<uint32_t>(summary.count);
+        block.min_t = summary.first_t;
+        block.max_t = summary.last_t;
+    } else {
+        Aggregates<CType> summary;
+        for (auto value: values) {
+            summary.add(0, value);
+        }
+        summary.storeTo(block);
+    }
+}
 
-            uint64_t value_bits = br_->readBits(64 - leading_zeros_ - trailing_zeros_);
-            value_bits <<= trailing_zeros_;
-            value_ ^= value_bits;
+// Encode `values` as a standalone timestamps (with `scale`) or values (with `codec`) stream described by `block`.
+template<typename CType>
+void encodeColumnStream(
+        std::span<const CType> values,
+        bool is_timestamp,
+        BitWriter &bw,
+        BlockInfo &block,
+        ValuesCodec codec = ValuesCodec::GORILLA,
+        const TimestampsScale &scale = {}
+) {
+    storeColumnSummary(values, is_timestamp, block);
+    if (is_timestamp) {
+        TimestampsEncoder c(bw, scale);
+        for (auto value: values) {
+            c.compress(toU64(value));
         }
+        c.finish();
+    } else {
+        withValuesEncoder(codec, bw, [&](auto &c) {
+            for (auto value: values) {
+                c.compress(toU64(value));
+            }
+            c.finish();
+        });
+    }
+}
+
+// Parallel mode of `serializeSingleColumnBatchToBuffer`: the column is split into segments of
+// `segment_points` points, each encoded from scratch on its own worker. Segments are stored as
+// blocks of a blocks container, must be read with `deserializeSingleColumnBatchParallel`.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeSingleColumnBatchParallel(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        size_t segment_points = DEFAULT_SEGMENT_POINTS,
+        size_t threads = defaultThreadsNumber(),
+        ValuesCodec codec = ValuesCodec::AUTO
+) {
+    auto initial_schema = batch->schema();
+    bool is_timestamp = initial_schema->field(0)->type()->id() == arrow::Type::TIMESTAMP;
+    std::vector<ValuesCodec> codecs;
+    initial_schema = withValuesCodecTags(initial_schema, is_timestamp ? 1 : 0, codec, codecs);
+    codec = codecs[0];
+    auto scale = detectTimestampsScale(*batch->column_data()[0]);
+    initial_schema = withTimestampsScaleTag(initial_schema, 0, scale);
+    initial_schema = withLayoutTag(initial_schema, BatchLayout::COLUMN_SEGMENTS);
+
+    if (segment_points == 0) {
+        return arrow::Status::Invalid("Segments must have at least one point.");
+    }
+    auto rows = static_cast<size_t>(batch->num_rows());
+    size_t segments_number = (rows + segment_points - 1) / segment_points;
+    std::vector<BitWriter> segments(segments_number);
+    std::vector<BlockInfo> blocks(segments_number);
+    ARROW_RETURN_NOT_OK(visitColumnValues(*batch->column_data()[0], [&](const auto *values, int64_t) {
+        parallelFor(segments_number, threads, [&](size_t k) {
+            size_t from = k * segment_points;
+            size_t to = std::min(rows, from + segment_points);
+            encodeColumnStream(std::span(values + from, to - from), is_timestamp, segments[k], blocks[k], codec,
+                               scale);
+        });
+        return arrow::Status::OK();
+    }));
 
-        return value_;
+    return serializeSegmentsWithSchema(initial_schema, segments, blocks);
+}
+
+// Parallel mode of `serializePairsBatchToBuffer` (see `serializeSingleColumnBatchParallel`).
+// Output is a blocks container, so it may be read with `BlockPairsReader` as well.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializePairsBatchParallel(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        size_t segment_points = DEFAULT_SEGMENT_POINTS,
+        size_t threads = defaultThreadsNumber()
+) {
+    auto scale = detectTimestampsScale(*batch->column_data()[0]);
+    auto initial_schema = withTimestampsScaleTag(batch->schema(), 0, scale);
+    initial_schema = withLayoutTag(initial_schema, BatchLayout::PAIRS_SEGMENTS);
+
+    if (segment_points == 0) {
+        return arrow::Status::Invalid("Segments must have at least one point.");
+    }
+    auto rows = static_cast<size_t>(batch->num_rows());
+    size_t segments_number = (rows + segment_points - 1) / segment_points;
+    std::vector<BitWriter> segments(segments_number);
+    std::vector<BlockInfo> blocks(segments_number);
+    const auto &ts_data = *batch->column_data()[0];
+    const auto &vs_data = *batch->column_data()[1];
+    ARROW_RETURN_NOT_OK(visitColumnValues(ts_data, [&](const auto *ts, int64_t) {
+        return visitColumnValues(vs_data, [&](const auto *vs, int64_t) {
+            parallelFor(segments_number, threads, [&](size_t k) {
+                size_t from = k * segment_points;
+                size_t to = std::min(rows, from + segment_points);
+                Aggregates<std::remove_cvref_t<decltype(*vs)>> summary;
+                PairsEncoder c(segments[k], scale);
+                for (size_t i = from; i < to; i++) {
+                    uint64_t t = toU64(ts[i]);
+                    summary.add(t, vs[i]);
+                    c.compress(std::make_pair(t, toU64(vs[i])));
+                }
+                c.finish();
+                summary.storeTo(blocks[k]);
+            });
+            return arrow::Status::OK();
+        });
+    }));
+
+    return serializeSegmentsWithSchema(initial_schema, segments, blocks);
+}
+
+// Multi-column batch is a timestamps column followed by any number of values columns sharing it.
+// Every column is encoded into its own stream stored as a block of a blocks container (in the
+// order of the schema fields), so any subset of columns may be decoded without touching the rest.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeMultiColumnBatchToBuffer(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        ValuesCodec codec = ValuesCodec::AUTO
+) {
+    auto initial_schema = batch->schema();
+    if (initial_schema->num_fields() == 0 || initial_schema->field(0)->type()->id() != arrow::Type::TIMESTAMP) {
+        return arrow::Status::TypeError("First column of a multi-column batch must be a timestamps column.");
+    }
+    std::vector<ValuesCodec> codecs;
+    initial_schema = withValuesCodecTags(initial_schema, 1, codec, codecs);
+    auto scale = detectTimestampsScale(*batch->column_data()[0]);
+    initial_schema = withTimestampsScaleTag(initial_schema, 0, scale);
+    initial_schema = withLayoutTag(initial_schema, BatchLayout::MULTI_COLUMN);
+
+    auto columns_number = static_cast<size_t>(batch->num_columns());
+    std::vector<BitWriter> streams(columns_number);
+    std::vector<BlockInfo> blocks(columns_number);
+    for (size_t k = 0; k < columns_number; k++) {
+        ARROW_RETURN_NOT_OK(visitColumnValues(*batch->column_data()[k], [&](const auto *values, int64_t length) {
+            encodeColumnStream(std::span(values, length), k == 0, streams[k], blocks[k], codecs[k], scale);
+            return arrow::Status::OK();
+        }));
     }
 
-private:
-    uint8_t leading_zeros_ = 0;
-    uint8_t trailing_zeros_ = 0;
-    uint64_t value_ = 0;
-};
+    return serializeSegmentsWithSchema(initial_schema, streams, blocks);
+}
 
-class PairsDecompressor : public DecompressorBase<std::pair<uint64_t, uint64_t>> {
-public:
-    explicit PairsDecompressor(const std::shared_ptr<BitReader> &br) : DecompressorBase(br), decompressor_ts_(br),
-                                                                       decompressor_value_(br) {}
+arrow::Result<std::string> serializeMultiColumnBatch(
+        const std::shared_ptr<arrow::RecordBatch> &batch,
+        ValuesCodec codec = ValuesCodec::AUTO
+) {
+    ARROW_ASSIGN_OR_RAISE(auto buffer, serializeMultiColumnBatchToBuffer(batch, codec));
+    return buffer->ToString();
+}
 
-    [[nodiscard]] uint64_t getHeader() const {
-        return decompressor_ts_.getHeader();
+// Multi-series container (see `SeriesContainer`) of pairs batches of many series sharing one schema,
+// which is written once in front of the container. Series are keyed by `uint64_t` keys (e.g. hashes
+// of the series labels) and encoded as interleaved counted streams with a common timestamps scale.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeSeriesContainer(
+        const std::vector<std::pair<uint64_t, std::shared_ptr<arrow::RecordBatch>>> &series
+) {
+    if (series.empty()) {
+        return arrow::Status::Invalid("Series container needs at least one series.");
     }
-
-private:
-    [[nodiscard]] std::optional<std::pair<uint64_t, uint64_t>> decompressFirstInner() override {
-        auto t = decompressor_ts_.decompressFirst();
-        if (!t) {
-            return std::nullopt;
+    const auto &schema = series[0].second->schema();
+    std::vector<size_t> order(series.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return series[a].first < series[b].first;
+    });
+
+    // Step of the timestamps is kept only when it's the same for all the series, otherwise the series
+    // are scaled by the unit only.
+    auto scale = detectTimestampsScale(*series[0].second->column_data()[0], false);
+    bool scale_detected = false;
+    size_t max_compressed_size = seriesDirectorySize(series.size());
+    for (size_t k = 0; k < order.size(); k++) {
+        const auto &[key, batch] = series[order[k]];
+        if (k > 0 && key == series[order[k - 1]].first) {
+            return arrow::Status::Invalid("Duplicate series key ", key, ".");
         }
-        auto v = decompressor_value_.decompressFirst();
-        if (!v) {
-            return std::nullopt;
+        if (!batch->schema()->Equals(*schema, false)) {
+            return arrow::Status::Invalid("Schema of series ", key, " differs from the one of series ",
+                                          series[0].first, ".");
+        }
+        max_compressed_size += PairsEncoder<>::maxCompressedSize(static_cast<size_t>(batch->num_rows()));
+        if (batch->num_rows() == 0) {
+            continue;
+        }
+        auto series_scale = detectTimestampsScale(*batch->column_data()[0]);
+        if (!scale_detected) {
+            scale = series_scale;
+            scale_detected = true;
+        } else if (series_scale.step != scale.step || series_scale.remainder != scale.remainder) {
+            scale = detectTimestampsScale(*batch->column_data()[0], false);
         }
-
-        return {std::make_pair(*t, *v)};
     }
+    auto initial_schema = withTimestampsScaleTag(schema, 0, scale);
+    initial_schema = withFormatVersionTag(initial_schema, FormatVersion::COUNTED);
+    initial_schema = withLayoutTag(initial_schema, BatchLayout::SERIES);
+
+    return serializeWithSchema(initial_schema, max_compressed_size, [&](BitWriter &bw) {
+        std::vector<SeriesInfo> directory;
+        directory.reserve(order.size());
+        for (size_t k: order) {
+            const auto &[key, batch] = series[k];
+            SeriesInfo info{key, bw.size(), static_cast<uint64_t>(batch->num_rows()), 0, 0};
+            ARROW_RETURN_NOT_OK(visitColumnValues(*batch->column_data()[0], [&](const auto *ts, int64_t length) {
+                for (int64_t i = 0; i < length; i++) {
+                    info.min_t = i == 0 ? toU64(ts[i]) : std::min(info.min_t, toU64(ts[i]));
+                    info.max_t = std::max(info.max_t, toU64(ts[i]));
+                }
+                return arrow::Status::OK();
+            }));
+            ARROW_RETURN_NOT_OK(encodePairs<PairsEncoder<>>(batch, scale, bw, FormatVersion::COUNTED));
+            directory.push_back(info);
+        }
+        std::vector<uint8_t> footer(seriesDirectorySize(directory.size()));
+        writeSeriesDirectory(footer.data(), directory);
+        bw.writeBytes(footer);
+        return arrow::Status::OK();
+    });
+}
 
-    std::optional<std::pair<uint64_t, uint64_t>> decompressNonFirst() override {
-        std::optional<uint64_t> t = decompressor_ts_.decompressNonFirst();
-        if (!t) {
-            return std::nullopt;
+// Number of first points of a block the sizes of the Gorilla based codecs are estimated on.
+constexpr size_t ADAPTIVE_SAMPLE_POINTS = 512;
+
+// General-purpose codecs applied to Gorilla streams by the adaptive mode
+// (null if not available in the Arrow build).
+struct GeneralPurposeCodecs {
+    std::unique_ptr<arrow::util::Codec> lz4;
+    std::unique_ptr<arrow::util::Codec> zstd;
+
+    static GeneralPurposeCodecs Make() {
+        GeneralPurposeCodecs codecs;
+        if (arrow::util::Codec::IsAvailable(arrow::Compression::LZ4_FRAME)) {
+            codecs.lz4 = arrow::util::Codec::Create(arrow::Compression::LZ4_FRAME).ValueOr(nullptr);
         }
-        std::optional<uint64_t> v = decompressor_value_.decompressNonFirst();
-        if (!v) {
-            return std::nullopt;
+        if (arrow::util::Codec::IsAvailable(arrow::Compression::ZSTD)) {
+            codecs.zstd = arrow::util::Codec::Create(arrow::Compression::ZSTD).ValueOr(nullptr);
         }
-        return {std::make_pair(*t, *v)};
+        return codecs;
     }
 
-    TimestampsDecompressor decompressor_ts_;
-    ValuesDecompressor decompressor_value_;
+    [[nodiscard]] arrow::util::Codec *get(BlockCodec codec) const {
+        return codec == BlockCodec::GORILLA_LZ4 ? lz4.get() : zstd.get();
+    }
 };
-// ---------- DECOMPRESSION ----------------
-
-
 
-// ---------- APACHE ARROW HELPERS --------------
-uint64_t getU64FromArrayData(
-        std::shared_ptr<arrow::DataType> &column_type,
-        std::shared_ptr<arrow::ArrayData> &array_data,
-        size_t i
-) {
-    uint64_t reinterpreted_value;
-    if (column_type->Equals(arrow::uint64())) {
-        uint64_t value = array_data->GetValues<uint64_t>(1)[i];
-        reinterpreted_value = *reinterpret_cast<uint64_t *>(&value);
-    } else if (column_type->Equals(arrow::uint32())) {
-        uint32_t value = array_data->GetValues<uint32_t>(1)[i];
-        reinterpreted_value = *reinterpret_cast<uint64_t *>(&value);
-    } else if (column_type->Equals(arrow::DoubleType())) {
-        double value = array_data->GetValues<double>(1)[i];
-        reinterpreted_value = *reinterpret_cast<uint64_t *>(&value);
-    } else if (column_type->Equals(arrow::TimestampType(arrow::TimeUnit::MICRO))) {
-        arrow::TimestampArray casted_timestamp_data(array_data);
-        reinterpreted_value = casted_timestamp_data.Value(i);
+void encodeGorillaStream(std::span<const uint64_t> values, bool is_timestamp, BitWriter &bw) {
+    if (is_timestamp) {
+        TimestampsEncoder c(bw);
+        for (auto value: values) {
+            c.compress(value);
+        }
+        c.finish();
     } else {
-        std::cerr << "Unknown value column type met for uint64_t serialization: " << *column_type << std::endl;
-        exit(1);
+        ValuesEncoder c(bw);
+        for (auto value: values) {
+            c.compress(value);
+        }
+        c.finish();
     }
-    return reinterpreted_value;
 }
 
-std::shared_ptr<arrow::ArrayBuilder> getColumnBuilderByType(
-        std::shared_ptr<arrow::DataType> &column_type
+// Compress `data` with `codec` into `out`, returns the compressed size.
+arrow::Result<size_t> compressGeneralPurpose(
+        arrow::util::Codec &codec,
+        std::span<const uint8_t> data,
+        std::vector<uint8_t> &out
 ) {
-    std::shared_ptr<arrow::ArrayBuilder> value_column_builder;
-    if (column_type->Equals(arrow::uint64())) {
-        value_column_builder = std::make_shared<arrow::UInt64Builder>();
-    } else if (column_type->Equals(arrow::uint32())) {
-        value_column_builder = std::make_shared<arrow::UInt32Builder>();
-    } else if (column_type->Equals(arrow::DoubleType())) {
-        value_column_builder = std::make_shared<arrow::DoubleBuilder>();
-    } else if (column_type->Equals(arrow::TimestampType(arrow::TimeUnit::MICRO))) {
-        value_column_builder = std::make_shared<arrow::TimestampBuilder>(
-                arrow::timestamp(arrow::TimeUnit::TimeUnit::MICRO), arrow::default_memory_pool());
-    } else {
-        std::cerr << "Unknown value column type met to get column builder: " << *column_type << std::endl;
-        exit(1);
-    }
-    return value_column_builder;
-}
-
-arrow::Status builderAppendValue(
-        std::shared_ptr<arrow::DataType> &column_type,
-        std::shared_ptr<arrow::ArrayBuilder> &column_builder,
-        uint64_t value
-) {
-    if (column_type->Equals(arrow::uint64())) {
-        ARROW_RETURN_NOT_OK(std::dynamic_pointer_cast<arrow::UInt64Builder>(column_builder)->Append(value));
-    } else if (column_type->Equals(arrow::uint32())) {
-        uint32_t reinterpreted_value = *reinterpret_cast<uint32_t *>(&value);
-        ARROW_RETURN_NOT_OK(
-                std::dynamic_pointer_cast<arrow::UInt32Builder>(column_builder)->Append(reinterpreted_value));
-    } else if (column_type->Equals(arrow::DoubleType())) {
-        double reinterpreted_value = *reinterpret_cast<double *>(&value);
-        ARROW_RETURN_NOT_OK(
-                std::dynamic_pointer_cast<arrow::DoubleBuilder>(column_builder)->Append(reinterpreted_value));
-    } else if (column_type->Equals(arrow::TimestampType(arrow::TimeUnit::MICRO))) {
-        ARROW_RETURN_NOT_OK(std::dynamic_pointer_cast<arrow::TimestampBuilder>(column_builder)->Append(value));
-    } else {
-        std::cerr << "Unknown value column type met to append value to builder: " << *column_type << std::endl;
-        exit(1);
+    out.resize(codec.MaxCompressedLen(static_cast<int64_t>(data.size()), data.data()));
+    ARROW_ASSIGN_OR_RAISE(auto size, codec.Compress(static_cast<int64_t>(data.size()), data.data(),
+                                                    static_cast<int64_t>(out.size()), out.data()));
+    return static_cast<size_t>(size);
+}
+
+// Encode `values` as one block (see `BlockCodec`) with the codec expected to give the smallest size.
+// Sizes of `DELTA`, `RLE`, `RAW` and `REGULAR` are computed exactly in one pass, sizes of the Gorilla based
+// codecs are extrapolated from the first `ADAPTIVE_SAMPLE_POINTS` values encoded (and compressed).
+arrow::Status encodeAdaptiveBlock(
+        std::span<const uint64_t> values,
+        bool is_timestamp,
+        const GeneralPurposeCodecs &codecs,
+        BitWriter &bw
+) {
+    auto sizes = blockCodecSizes(values);
+    if (sizes.regular <= std::min({sizes.delta, sizes.rle, sizes.raw})) {
+        // Gorilla based codecs spend at least a bit per value, so they're not tried.
+        bw.writeByte(static_cast<uint8_t>(BlockCodec::REGULAR));
+        encodeRegularBlock(values, bw);
+        bw.flush(false);
+        return arrow::Status::OK();
+    }
+
+    auto sample_values = values.first(std::min(values.size(), ADAPTIVE_SAMPLE_POINTS));
+    BitWriter sample;
+    encodeGorillaStream(sample_values, is_timestamp, sample);
+    auto extrapolate = [&](size_t sample_size) {
+        return sample_values.empty() ? sample_size : sample_size * values.size() / sample_values.size();
+    };
+
+    BlockCodec best = BlockCodec::GORILLA;
+    size_t best_size = 1 + extrapolate(sample.size());
+    auto consider = [&](BlockCodec codec, size_t size) {
+        if (size < best_size) {
+            best = codec;
+            best_size = size;
+        }
+    };
+    consider(BlockCodec::DELTA, sizes.delta);
+    consider(BlockCodec::RLE, sizes.rle);
+    consider(BlockCodec::RAW, sizes.raw);
+    std::vector<uint8_t> compressed;
+    for (auto codec: {BlockCodec::GORILLA_LZ4, BlockCodec::GORILLA_ZSTD}) {
+        if (auto *general_purpose = codecs.get(codec)) {
+            ARROW_ASSIGN_OR_RAISE(auto size, compressGeneralPurpose(*general_purpose,
+                                                                    std::span(sample.data(), sample.size()),
+                                                                    compressed));
+            consider(codec, 1 + sizeof(uint32_t) + extrapolate(size));
+        }
     }
+
+    bw.writeByte(static_cast<uint8_t>(best));
+    switch (best) {
+        case BlockCodec::DELTA:
+            encodeDeltaBlock(values, bw);
+            break;
+        case BlockCodec::RLE:
+            encodeRleBlock(values, bw);
+            break;
+        case BlockCodec::RAW:
+            encodeRawBlock(values, bw);
+            break;
+        default: {
+            BitWriter gorilla;
+            if (sample_values.size() != values.size()) {
+                encodeGorillaStream(values, is_timestamp, gorilla);
+            }
+            const auto &stream = sample_values.size() != values.size() ? gorilla : sample;
+            std::span<const uint8_t> stream_bytes(stream.data(), stream.size());
+            if (best == BlockCodec::GORILLA) {
+                bw.writeBytes(stream_bytes);
+                break;
+            }
+            ARROW_ASSIGN_OR_RAISE(auto size, compressGeneralPurpose(*codecs.get(best), stream_bytes, compressed));
+            uint8_t stream_size[sizeof(uint32_t)];
+            storeLittleEndian(stream_size, static_cast<uint32_t>(stream_bytes.size()));
+            bw.writeBytes(stream_size);
+            bw.writeBytes(std::span(compressed.data(), size));
+        }
+    }
+    bw.flush(false);
     return arrow::Status::OK();
 }
 
-std::vector<uint64_t> getU64VecFromBatch(
+// Adaptive mode of `serializeSingleColumnBatchToBuffer`: every block of `block_points` points is
+// encoded with its own codec (see `encodeAdaptiveBlock`), blocks are stored in a blocks container.
+// Must be read with `deserializeSingleColumnBatchAdaptive`. `block_points` must be in
+// `[1, MAX_ADAPTIVE_BLOCK_POINTS]`.
+arrow::Result<std::shared_ptr<arrow::Buffer>> serializeSingleColumnBatchAdaptive(
         const std::shared_ptr<arrow::RecordBatch> &batch,
-        size_t column_index
+        size_t block_points = DEFAULT_BLOCK_POINTS
 ) {
-    std::vector<uint64_t> entities_vec;
-    auto data = batch->column_data()[column_index];
-    auto column_type = batch->schema()->field(column_index)->type();
-    auto array_size = data->length;
-
-    entities_vec.reserve(array_size);
-    for (int i = 0; i < array_size; i++) {
-        uint64_t reinterpretedValue = getU64FromArrayData(column_type, data, i);
-        entities_vec.push_back(reinterpretedValue);
+    if (block_points == 0 || block_points > MAX_ADAPTIVE_BLOCK_POINTS) {
+        return arrow::Status::Invalid("Adaptive blocks may have from 1 to ", MAX_ADAPTIVE_BLOCK_POINTS,
+                                      " points, got: ", block_points, ".");
     }
+    auto initial_schema = withLayoutTag(batch->schema(), BatchLayout::ADAPTIVE);
+    bool is_timestamp = initial_schema->field(0)->type()->id() == arrow::Type::TIMESTAMP;
+
+    auto rows = static_cast<size_t>(batch->num_rows());
+    size_t blocks_number = (rows + block_points - 1) / block_points;
+    std::vector<BitWriter> streams(blocks_number);
+    std::vector<BlockInfo> blocks(blocks_number);
+    auto codecs = GeneralPurposeCodecs::Make();
+    std::vector<uint64_t> block_values;
+    ARROW_RETURN_NOT_OK(visitColumnValues(*batch->column_data()[0], [&](const auto *values, int64_t) {
+        for (size_t k = 0; k < blocks_number; k++) {
+            size_t from = k * block_points;
+            size_t to = std::min(rows, from + block_points);
+            storeColumnSummary(std::span(values + from, to - from), is_timestamp, blocks[k]);
+            block_values.resize(to - from);
+            std::transform(values + from, values + to, block_values.begin(), [](auto v) { return toU64(v); });
+            ARROW_RETURN_NOT_OK(encodeAdaptiveBlock(block_values, is_timestamp, codecs, streams[k]));
+        }
+        return arrow::Status::OK();
+    }));
 
-    return entities_vec;
+    return serializeSegmentsWithSchema(initial_schema, streams, blocks);
 }
 
-template<typename T, typename F>
-arrow::Result<std::string> serializeBatchEntities(
-        const std::shared_ptr<arrow::Schema> &batch_schema,
-        std::vector<T> &entities,
-        F create_c_func
-) {
-    auto schema_serialized_buffer = arrow::ipc::SerializeSchema(*batch_schema).ValueOrDie();
-    auto schema_serialized_str = schema_serialized_buffer->ToString();
+// Number of entities decoded per `decodeInto` call when the size of the series is unknown.
+const size_t DECODE_CHUNK_SIZE = 4096;
 
-    std::stringstream out_stream;
-    auto arrays_size = entities.size();
+// Growable values buffer of a column filled by decoders with `uint64_t` entities.
+//
+// For 64-bit column types the decoders write straight into the buffer; 32-bit entities are
+// decoded into a staging chunk and narrowed. The result is wrapped as `arrow::ArrayData`
+// without any per-element builder calls.
+class ColumnDataOutput {
+public:
+    static arrow::Result<ColumnDataOutput> Make(
+            const std::shared_ptr<arrow::DataType> &type,
+            arrow::MemoryPool *pool = arrow::default_memory_pool()
+    ) {
+        int byte_width = 0;
+        ARROW_RETURN_NOT_OK(visitColumnType(*type, [&byte_width](auto type_tag) {
+            byte_width = sizeof(typename decltype(type_tag)::type);
+            return arrow::Status::OK();
+        }));
+        ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::ResizableBuffer> buffer, arrow::AllocateResizableBuffer(0, pool));
+        return ColumnDataOutput(type, std::move(buffer), byte_width);
+    }
 
-    std::unique_ptr<CompressorBase<T>> c = create_c_func(out_stream);
-    for (int i = 0; i < arrays_size; i++) {
-        c->compress(entities[i]);
+    // Space for the next `n` entities. Must be followed by `commit`.
+    arrow::Result<std::span<uint64_t>> prepare(size_t n) {
+        if (length_ + n > capacity_) {
+            capacity_ = std::max(capacity_ * 2, length_ + n);
+            ARROW_RETURN_NOT_OK(buffer_->Reserve(static_cast<int64_t>(capacity_ * byte_width_)));
+        }
+        if (byte_width_ == sizeof(uint64_t)) {
+            return std::span(reinterpret_cast<uint64_t *>(buffer_->mutable_data()) + length_, n);
+        }
+        staging_.resize(n);
+        return std::span(staging_);
     }
-    c->finish();
-    std::string compressed = out_stream.str();
 
-    return {std::to_string(schema_serialized_str.length()) + "\n" + schema_serialized_str + compressed};
-}
+    // Append `n` entities written to the space returned by the last `prepare`.
+    void commit(size_t n) {
+        if (byte_width_ != sizeof(uint64_t)) {
+            auto out = reinterpret_cast<uint32_t *>(buffer_->mutable_data()) + length_;
+            for (size_t i = 0; i < n; i++) {
+                out[i] = static_cast<uint32_t>(staging_[i]);
+            }
+        }
+        length_ += n;
+    }
 
-arrow::Result<std::string> serializeSingleColumnBatch(
-        const std::shared_ptr<arrow::RecordBatch> &batch
-) {
-    auto initial_schema = batch->schema();
-    auto column_type = initial_schema->field(0)->type();
+    [[nodiscard]] size_t length() const {
+        return length_;
+    }
 
-    auto entities_vec = getU64VecFromBatch(batch, 0);
-    arrow::Result<std::string> serialization_res;
-    if (column_type->Equals(arrow::TimestampType(arrow::TimeUnit::MICRO))) {
-        serialization_res = serializeBatchEntities(initial_schema, entities_vec, [](std::stringstream &out_stream) {
-            auto bw = std::make_shared<BitWriter>(out_stream);
-            return std::make_unique<TimestampsCompressor>(bw);
-        });
-    } else {
-        serialization_res = serializeBatchEntities(initial_schema, entities_vec, [](std::stringstream &out_stream) {
-            auto bw = std::make_shared<BitWriter>(out_stream);
-            return std::make_unique<ValuesCompressor>(bw);
-        });
+    arrow::Result<std::shared_ptr<arrow::ArrayData>> finish() {
+        ARROW_RETURN_NOT_OK(buffer_->Resize(static_cast<int64_t>(length_ * byte_width_)));
+        return arrow::ArrayData::Make(type_, static_cast<int64_t>(length_), {nullptr, std::move(buffer_)}, 0);
+    }
+
+private:
+    ColumnDataOutput(std::shared_ptr<arrow::DataType> type, std::shared_ptr<arrow::ResizableBuffer> buffer,
+                     int byte_width) : type_(std::move(type)), buffer_(std::move(buffer)), byte_width_(byte_width) {}
+
+    std::shared_ptr<arrow::DataType> type_;
+    std::shared_ptr<arrow::ResizableBuffer> buffer_;
+    size_t byte_width_;
+    size_t length_ = 0;
+    size_t capacity_ = 0;
+    std::vector<uint64_t> staging_;
+};
+
+// Error of a series decoded with `br` past the end of its data. The zeros read there decode as repeats
+// of the previous entity, so a series without its end marker would never end otherwise.
+arrow::Status checkEndMarkerReached(const BitReader &br) {
+    if (br.pastEnd()) {
+        return arrow::Status::SerializationError("Series end marker is missing.");
     }
-    return serialization_res;
+    return arrow::Status::OK();
 }
 
-arrow::Result<std::string> serializePairsBatch(
-        const std::shared_ptr<arrow::RecordBatch> &batch
+// Decode the whole series with `D` timestamps or values decoder (or decompressor) reading from `br`
+// into `output`.
+template<typename D>
+arrow::Status deserializeEntities(D &d, const BitReader &br, ColumnDataOutput &output) {
+    size_t decoded;
+    do {
+        ARROW_RETURN_NOT_OK(checkEndMarkerReached(br));
+        ARROW_ASSIGN_OR_RAISE(auto out, output.prepare(DECODE_CHUNK_SIZE));
+        decoded = d.decodeInto(out);
+        output.commit(decoded);
+    } while (decoded == DECODE_CHUNK_SIZE);
+    return checkEndMarkerReached(br);
+}
+
+// Decode the whole series with `D` pairs decoder (or decompressor) reading from `br` into `ts_output`
+// and `vs_output`.
+template<typename D>
+arrow::Status deserializePairEntities(
+        D &d,
+        const BitReader &br,
+        ColumnDataOutput &ts_output,
+        ColumnDataOutput &vs_output
 ) {
-    auto initial_schema = batch->schema();
+    size_t decoded;
+    do {
+        ARROW_RETURN_NOT_OK(checkEndMarkerReached(br));
+        ARROW_ASSIGN_OR_RAISE(auto ts, ts_output.prepare(DECODE_CHUNK_SIZE));
+        ARROW_ASSIGN_OR_RAISE(auto vs, vs_output.prepare(DECODE_CHUNK_SIZE));
+        decoded = d.decodeInto(ts, vs);
+        ts_output.commit(decoded);
+        vs_output.commit(decoded);
+    } while (decoded == DECODE_CHUNK_SIZE);
+    return checkEndMarkerReached(br);
+}
 
-    auto ts_vec = getU64VecFromBatch(batch, 0);
-    auto vs_vec = getU64VecFromBatch(batch, 1);
-    std::vector<std::pair<uint64_t, uint64_t>> zipped(ts_vec.size());
-    std::transform(ts_vec.begin(), ts_vec.end(), vs_vec.begin(), zipped.begin(),
-                   [](uint64_t a, uint64_t b) { return std::make_pair(a, b); });
-
-    arrow::Result<std::string> serialization_res = serializeBatchEntities(
-            initial_schema,
-            zipped,
-            [](std::stringstream &out_stream) {
-                auto bw = std::make_shared<BitWriter>(out_stream);
-                return std::make_unique<PairsCompressor>(bw);
-            });
-    return serialization_res;
+// Decode `count` entities of a series ended with `finishCounted` with `D` timestamps or values decoder
+// into `output` allocated once.
+template<typename D>
+arrow::Status deserializeCountedEntities(D &d, size_t count, ColumnDataOutput &output) {
+    ARROW_ASSIGN_OR_RAISE(auto out, output.prepare(count));
+    d.decodeCounted(out);
+    output.commit(count);
+    return arrow::Status::OK();
 }
 
-template<typename T>
-std::vector<T> deserializeEntities(
-        std::unique_ptr<DecompressorBase<T>> &d
+// Decode `count` pairs of a series ended with `finishCounted` with `D` pairs decoder.
+template<typename D>
+arrow::Status deserializeCountedPairEntities(
+        D &d,
+        size_t count,
+        ColumnDataOutput &ts_output,
+        ColumnDataOutput &vs_output
 ) {
-    std::vector<T> entities;
-    std::optional<T> current_pair;
-    do {
-        current_pair = d->next();
-        if (current_pair) {
-            entities.push_back(*current_pair);
-        }
-    } while (current_pair);
-    return entities;
+    ARROW_ASSIGN_OR_RAISE(auto ts, ts_output.prepare(count));
+    ARROW_ASSIGN_OR_RAISE(auto vs, vs_output.prepare(count));
+    d.decodeCounted(ts, vs);
+    ts_output.commit(count);
+    vs_output.commit(count);
+    return arrow::Status::OK();
 }
 
-arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatch(
-        const std::string &data
+// Decode a standalone timestamps or values stream into `output`: `count` entities of a stream ended
+// with `finishCounted`, or a stream of unknown size ended with `finish` when `count` is not given.
+// An empty stream holds an empty series (see `SplitPairsEncoder`).
+arrow::Status deserializeColumnStream(
+        std::span<const uint8_t> stream,
+        bool is_timestamp,
+        ColumnDataOutput &output,
+        ValuesCodec codec = ValuesCodec::GORILLA,
+        const TimestampsScale &scale = {},
+        std::optional<size_t> count = std::nullopt
 ) {
-    // Deserialize batch schema.
+    if (stream.empty()) {
+        return arrow::Status::OK();
+    }
+    BitReader br(stream);
+    auto deserialize = [&](auto &d) {
+        return count ? deserializeCountedEntities(d, *count, output) : deserializeEntities(d, br, output);
+    };
+    if (is_timestamp) {
+        TimestampsDecoder d(br, scale);
+        return deserialize(d);
+    }
+    return withValuesDecoder(codec, br, deserialize);
+}
+
+// Serialized batch split into the schema and the compressed payload (pointing into the serialized data).
+struct SerializedBatchView {
+    std::shared_ptr<arrow::Schema> schema;
+    std::span<const uint8_t> payload;
+};
+
+// Parse `<schema length>\n<schema><payload>` layout written by `serializeWithSchema` in place.
+arrow::Result<SerializedBatchView> parseSerializedBatch(std::string_view data) {
     size_t div_pos = data.find_first_of('\n');
-    if (div_pos == std::string::npos) {
-        std::cerr << "Newline divider not found in serialized file." << std::endl;
-        exit(1);
+    if (div_pos == std::string_view::npos) {
+        return arrow::Status::SerializationError("Newline divider not found in serialized data.");
     }
-    size_t schema_length;
-    std::stringstream header_ss((data.substr(0, div_pos)));
-    header_ss >> schema_length;
+    size_t schema_length = 0;
+    auto [ptr, ec] = std::from_chars(data.data(), data.data() + div_pos, schema_length);
     size_t schema_from_pos = div_pos + 1;
-    auto reader_stream = arrow::io::BufferReader::FromString(data.substr(schema_from_pos));
+    if (ec != std::errc() || ptr != data.data() + div_pos || schema_length > data.size() - schema_from_pos) {
+        return arrow::Status::SerializationError("Invalid schema length in serialized data.");
+    }
+
+    auto bytes = reinterpret_cast<const uint8_t *>(data.data());
+    // Non-owning buffer, the schema is read without copying `data`.
+    auto schema_buffer = std::make_shared<arrow::Buffer>(bytes + schema_from_pos,
+                                                         static_cast<int64_t>(schema_length));
+    arrow::io::BufferReader reader_stream(schema_buffer);
     arrow::ipc::DictionaryMemo dictMemo;
-    auto schema = arrow::ipc::ReadSchema(reader_stream.get(), &dictMemo).ValueOrDie();
+    ARROW_ASSIGN_OR_RAISE(auto schema, arrow::ipc::ReadSchema(&reader_stream, &dictMemo));
+
+    size_t payload_from_pos = schema_from_pos + schema_length;
+    return SerializedBatchView{std::move(schema),
+                               std::span<const uint8_t>(bytes + payload_from_pos, data.size() - payload_from_pos)};
+}
+
+std::string_view toStringView(const std::shared_ptr<arrow::Buffer> &buffer) {
+    return {reinterpret_cast<const char *>(buffer->data()), static_cast<size_t>(buffer->size())};
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatch(
+        std::string_view data
+) {
+    // Deserialize batch schema.
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::STREAMS));
+    ARROW_ASSIGN_OR_RAISE(auto codecs, takeValuesCodecTags(schema));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
 
     // Deserialize data.
     auto column_type = schema->field(0)->type();
-    std::stringstream in_stream(data.substr(schema_from_pos + schema_length));
-    auto br = std::make_shared<BitReader>(in_stream);
-    std::unique_ptr<DecompressorBase<uint64_t>> d;
-    if (column_type->Equals(arrow::TimestampType(arrow::TimeUnit::MICRO))) {
-        d = std::make_unique<TimestampsDecompressor>(br);
-    } else {
-        d = std::make_unique<ValuesDecompressor>(br);
+    if (version == FormatVersion::APPENDABLE) {
+        return arrow::Status::SerializationError("Appendable format of a single column batch.");
     }
-    auto entities = deserializeEntities(d);
-
-    auto column_builder = getColumnBuilderByType(column_type);
-    for (auto e: entities) {
-        ARROW_RETURN_NOT_OK(builderAppendValue(column_type, column_builder, e));
+    auto stream = view.payload;
+    std::optional<size_t> count;
+    if (version == FormatVersion::COUNTED) {
+        ARROW_ASSIGN_OR_RAISE(std::tie(count, stream), readPointsCount(view.payload));
     }
+    ARROW_ASSIGN_OR_RAISE(auto output, ColumnDataOutput::Make(column_type));
+    ARROW_RETURN_NOT_OK(deserializeColumnStream(stream, column_type->id() == arrow::Type::TIMESTAMP, output,
+                                                codecs[0], scale, count));
 
-    std::shared_ptr<arrow::Array> column_array;
-    ARROW_ASSIGN_OR_RAISE(column_array, column_builder->Finish());
-
-    std::shared_ptr<arrow::RecordBatch> batch_deserialized = arrow::RecordBatch::Make(schema, entities.size(),
-                                                                                      {column_array});
+    ARROW_ASSIGN_OR_RAISE(auto column_data, output.finish());
+    std::shared_ptr<arrow::RecordBatch> batch_deserialized = arrow::RecordBatch::Make(schema, column_data->length,
+                                                                                      {column_data});
 
     auto validation = batch_deserialized->Validate();
     if (!validation.ok()) {
@@ -855,46 +5073,74 @@ arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatch(
     return {batch_deserialized};
 }
 
-arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatch(
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatch(
         const std::string &data
+) {
+    return deserializeSingleColumnBatch(std::string_view(data));
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatch(
+        const std::shared_ptr<arrow::Buffer> &data
+) {
+    return deserializeSingleColumnBatch(toStringView(data));
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatch(
+        std::string_view data,
+        PairsLayout layout = PairsLayout::INTERLEAVED,
+        size_t threads = 1
 ) {
     // Deserialize batch schema.
-    size_t div_pos = data.find_first_of('\n');
-    if (div_pos == std::string::npos) {
-        std::cerr << "Newline divider not found in serialized file." << std::endl;
-        exit(1);
-    }
-    size_t schema_length;
-    std::stringstream header_ss((data.substr(0, div_pos)));
-    header_ss >> schema_length;
-    size_t schema_from_pos = div_pos + 1;
-    auto reader_stream = arrow::io::BufferReader::FromString(data.substr(schema_from_pos));
-    arrow::ipc::DictionaryMemo dictMemo;
-    auto schema = arrow::ipc::ReadSchema(reader_stream.get(), &dictMemo).ValueOrDie();
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, layout == PairsLayout::SPLIT ? BatchLayout::SPLIT_PAIRS
+                                                                           : BatchLayout::STREAMS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
 
     // Deserialize data.
-    std::stringstream in_stream(data.substr(schema_from_pos + schema_length));
-    auto br = std::make_shared<BitReader>(in_stream);
-    std::unique_ptr<DecompressorBase<std::pair<uint64_t, uint64_t>>> d = std::make_unique<PairsDecompressor>(br);
-    auto entities = deserializeEntities(d);
-
-    auto ts_column_type = schema->field(0)->type();
-    auto vs_column_type = schema->field(1)->type();
-    auto ts_column_builder = getColumnBuilderByType(ts_column_type);
-    auto vs_column_builder = getColumnBuilderByType(vs_column_type);
-    for (auto [t, v]: entities) {
-        ARROW_RETURN_NOT_OK(builderAppendValue(ts_column_type, ts_column_builder, t));
-        ARROW_RETURN_NOT_OK(builderAppendValue(vs_column_type, vs_column_builder, v));
+    auto streams = view.payload;
+    std::optional<size_t> count;
+    if (layout == PairsLayout::INTERLEAVED) {
+        ARROW_ASSIGN_OR_RAISE(std::tie(count, streams), readPairsStream(view.payload, version));
+    } else if (version == FormatVersion::COUNTED) {
+        ARROW_ASSIGN_OR_RAISE(std::tie(count, streams), readPointsCount(view.payload));
+    } else if (version == FormatVersion::APPENDABLE) {
+        return arrow::Status::SerializationError("Appendable format of the split layout.");
+    }
+    ARROW_ASSIGN_OR_RAISE(auto ts_output, ColumnDataOutput::Make(schema->field(0)->type()));
+    ARROW_ASSIGN_OR_RAISE(auto vs_output, ColumnDataOutput::Make(schema->field(1)->type()));
+    if (layout == PairsLayout::SPLIT) {
+        // Sections are independent, so the columns may be decoded on different threads.
+        ARROW_ASSIGN_OR_RAISE(auto d, SplitPairsDecoder<>::Make(streams));
+        arrow::Status statuses[2];
+        parallelFor(2, threads, [&](size_t k) {
+            statuses[k] = k == 0 ? deserializeColumnStream(d.timestampsSection(), true, ts_output,
+                                                           ValuesCodec::GORILLA, scale, count)
+                                 : deserializeColumnStream(d.valuesSection(), false, vs_output,
+                                                           ValuesCodec::GORILLA, {}, count);
+        });
+        ARROW_RETURN_NOT_OK(statuses[0]);
+        ARROW_RETURN_NOT_OK(statuses[1]);
+        if (ts_output.length() != vs_output.length()) {
+            return arrow::Status::SerializationError("Split pairs sections have ", ts_output.length(),
+                                                     " timestamps and ", vs_output.length(), " values.");
+        }
+    } else if (count) {
+        BitReader br(streams);
+        PairsDecoder d(br, scale);
+        ARROW_RETURN_NOT_OK(deserializeCountedPairEntities(d, *count, ts_output, vs_output));
+    } else {
+        BitReader br(streams);
+        PairsDecoder d(br, scale);
+        ARROW_RETURN_NOT_OK(deserializePairEntities(d, br, ts_output, vs_output));
     }
 
-    std::shared_ptr<arrow::Array> ts_column_array;
-    ARROW_ASSIGN_OR_RAISE(ts_column_array, ts_column_builder->Finish());
-    std::shared_ptr<arrow::Array> vs_column_array;
-    ARROW_ASSIGN_OR_RAISE(vs_column_array, vs_column_builder->Finish());
-
-    std::shared_ptr<arrow::RecordBatch> batch_deserialized = arrow::RecordBatch::Make(schema, entities.size(),
-                                                                                      {ts_column_array,
-                                                                                       vs_column_array});
+    ARROW_ASSIGN_OR_RAISE(auto ts_column_data, ts_output.finish());
+    ARROW_ASSIGN_OR_RAISE(auto vs_column_data, vs_output.finish());
+    std::shared_ptr<arrow::RecordBatch> batch_deserialized = arrow::RecordBatch::Make(schema, ts_column_data->length,
+                                                                                      {ts_column_data,
+                                                                                       vs_column_data});
 
     auto validation = batch_deserialized->Validate();
     if (!validation.ok()) {
@@ -904,4 +5150,501 @@ arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatch(
 
     return {batch_deserialized};
 }
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatch(
+        const std::string &data,
+        PairsLayout layout = PairsLayout::INTERLEAVED,
+        size_t threads = 1
+) {
+    return deserializePairsBatch(std::string_view(data), layout, threads);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatch(
+        const std::shared_ptr<arrow::Buffer> &data,
+        PairsLayout layout = PairsLayout::INTERLEAVED,
+        size_t threads = 1
+) {
+    return deserializePairsBatch(toStringView(data), layout, threads);
+}
+
+// Decode only the timestamps column of a pairs batch serialized with `PairsLayout::SPLIT`
+// (values section is not touched).
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatchTimestamps(
+        std::string_view data
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::SPLIT_PAIRS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
+
+    auto streams = view.payload;
+    std::optional<size_t> count;
+    if (version == FormatVersion::APPENDABLE) {
+        return arrow::Status::SerializationError("Appendable format of the split layout.");
+    }
+    if (version == FormatVersion::COUNTED) {
+        ARROW_ASSIGN_OR_RAISE(std::tie(count, streams), readPointsCount(view.payload));
+    }
+    ARROW_ASSIGN_OR_RAISE(auto d, SplitPairsDecoder<>::Make(streams));
+    ARROW_ASSIGN_OR_RAISE(auto ts_output, ColumnDataOutput::Make(schema->field(0)->type()));
+    ARROW_RETURN_NOT_OK(deserializeColumnStream(d.timestampsSection(), true, ts_output, ValuesCodec::GORILLA, scale,
+                                                count));
+
+    ARROW_ASSIGN_OR_RAISE(auto ts_column_data, ts_output.finish());
+    return arrow::RecordBatch::Make(arrow::schema({schema->field(0)}, schema->metadata()), ts_column_data->length,
+                                    {ts_column_data});
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatchTimestamps(
+        const std::string &data
+) {
+    return deserializePairsBatchTimestamps(std::string_view(data));
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatchTimestamps(
+        const std::shared_ptr<arrow::Buffer> &data
+) {
+    return deserializePairsBatchTimestamps(toStringView(data));
+}
+
+// Checkpoint index (see `PairsCheckpointIndex`) of a pairs batch serialized with
+// `PairsLayout::INTERLEAVED`, built by decoding the batch once. The index is kept aside of the batch.
+arrow::Result<PairsCheckpointIndex> buildPairsCheckpointIndex(
+        std::string_view data,
+        size_t points_per_checkpoint = DEFAULT_CHECKPOINT_POINTS
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::STREAMS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
+    ARROW_ASSIGN_OR_RAISE(auto count_and_stream, readPairsStream(view.payload, version));
+    auto &[count, stream] = count_and_stream;
+    return PairsCheckpointIndex::build(stream, scale, count, points_per_checkpoint);
+}
+
+// Pair (as passed to the codecs, see `toU64`) of row `row` of a pairs batch serialized with
+// `PairsLayout::INTERLEAVED`. Decoding starts from the checkpoint of `index` nearest to the row.
+arrow::Result<std::pair<uint64_t, uint64_t>> readPairsRow(
+        std::string_view data,
+        const PairsCheckpointIndex &index,
+        size_t row
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::STREAMS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
+    ARROW_ASSIGN_OR_RAISE(auto count_and_stream, readPairsStream(view.payload, version));
+    auto &[count, stream] = count_and_stream;
+    if (count && *count != index.count()) {
+        return arrow::Status::Invalid("Checkpoint index of ", index.count(), " rows for a batch of ", *count,
+                                      " rows.");
+    }
+    PairsRowReader reader(stream, index, scale);
+    if (!reader.seekToRow(row)) {
+        return arrow::Status::IndexError("Row is out of range of ", index.count(), " rows.");
+    }
+    return *reader.next();
+}
+
+// Append the pairs of `batch` to the pairs batch `serialized` with `FormatVersion::APPENDABLE` in place.
+// Only the new pairs are encoded: the encoder is restored from the trailer and continues the series
+// from its last bit, which is followed by a new trailer.
+arrow::Status appendTo(std::string &serialized, const std::shared_ptr<arrow::RecordBatch> &batch) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(serialized));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::STREAMS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
+    if (version != FormatVersion::APPENDABLE) {
+        return arrow::Status::Invalid("Serialized batch isn't appendable.");
+    }
+    if (!schema->Equals(*batch->schema(), false)) {
+        return arrow::Status::Invalid("Schema of the appended batch differs from the serialized one.");
+    }
+    ARROW_ASSIGN_OR_RAISE(auto trailer_and_stream, readPairsTrailer(view.payload));
+    auto &[trailer, stream] = trailer_and_stream;
+
+    // Bits of the last partially filled byte are written again.
+    size_t whole_bytes = trailer.bit_size / 8;
+    int rest_bits = static_cast<int>(trailer.bit_size % 8);
+    BitWriter bw;
+    if (rest_bits > 0) {
+        bw.writeBits(stream[whole_bytes] >> (8 - rest_bits), rest_bits);
+    }
+    PairsEncoder<> c(bw, scale);
+    if (trailer.count > 0) {
+        c.restore(trailer.state);
+    }
+    ARROW_RETURN_NOT_OK(compressPairs(batch, c));
+    trailer.count += static_cast<uint64_t>(batch->num_rows());
+    trailer.bit_size = whole_bytes * 8 + bw.bitSize();
+    trailer.state = c.state();
+    c.finishCounted();
+    trailer.write(bw);
+
+    auto stream_offset = static_cast<size_t>(reinterpret_cast<const char *>(stream.data()) - serialized.data());
+    serialized.resize(stream_offset + whole_bytes);
+    serialized.append(reinterpret_cast<const char *>(bw.data()), bw.size());
+    return arrow::Status::OK();
+}
+
+// Decode a standalone timestamps or values stream into `out`, returns the number of decoded entities.
+size_t decodeColumnStream(
+        std::span<const uint8_t> stream,
+        bool is_timestamp,
+        std::span<uint64_t> out,
+        ValuesCodec codec = ValuesCodec::GORILLA,
+        const TimestampsScale &scale = {}
+) {
+    BitReader br(stream);
+    if (is_timestamp) {
+        TimestampsDecoder d(br, scale);
+        return d.decodeInto(out);
+    }
+    return withValuesDecoder(codec, br, [&](auto &d) {
+        return d.decodeInto(out);
+    });
+}
+
+// Decode every block of `container` with `decode_block(k, offset)` on up to `threads` threads,
+// where `offset` is the number of points in the preceding blocks.
+template<typename F>
+arrow::Status decodeBlocksParallel(const BlocksContainer &container, size_t threads, F decode_block) {
+    const auto &blocks = container.blocks();
+    std::vector<size_t> offsets(blocks.size());
+    for (size_t k = 1; k < blocks.size(); k++) {
+        offsets[k] = offsets[k - 1] + blocks[k - 1].count;
+    }
+    std::vector<size_t> decoded(blocks.size());
+    parallelFor(blocks.size(), threads, [&](size_t k) {
+        decoded[k] = decode_block(k, offsets[k]);
+    });
+    for (size_t k = 0; k < blocks.size(); k++) {
+        if (decoded[k] != blocks[k].count) {
+            return arrow::Status::SerializationError("Segment ", k, " has ", decoded[k], " points instead of ",
+                                                     blocks[k].count, ".");
+        }
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatchParallel(
+        std::string_view data,
+        size_t threads = defaultThreadsNumber()
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::COLUMN_SEGMENTS));
+    ARROW_ASSIGN_OR_RAISE(auto codecs, takeValuesCodecTags(schema));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    auto column_type = schema->field(0)->type();
+    bool is_timestamp = column_type->id() == arrow::Type::TIMESTAMP;
+
+    ARROW_ASSIGN_OR_RAISE(auto container, BlocksContainer::Make(view.payload));
+    ARROW_ASSIGN_OR_RAISE(auto output, ColumnDataOutput::Make(column_type));
+    ARROW_ASSIGN_OR_RAISE(auto out, output.prepare(container.size()));
+    ARROW_RETURN_NOT_OK(decodeBlocksParallel(container, threads, [&](size_t k, size_t offset) {
+        return decodeColumnStream(container.blockData(k), is_timestamp,
+                                  out.subspan(offset, container.blocks()[k].count), codecs[0], scale);
+    }));
+    output.commit(container.size());
+
+    ARROW_ASSIGN_OR_RAISE(auto column_data, output.finish());
+    return arrow::RecordBatch::Make(schema, column_data->length, {column_data});
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatchParallel(
+        const std::shared_ptr<arrow::Buffer> &data,
+        size_t threads = defaultThreadsNumber()
+) {
+    return deserializeSingleColumnBatchParallel(toStringView(data), threads);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatchParallel(
+        std::string_view data,
+        size_t threads = defaultThreadsNumber()
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::PAIRS_SEGMENTS));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+
+    ARROW_ASSIGN_OR_RAISE(auto reader, BlockPairsReader::Make(view.payload, scale));
+    ARROW_ASSIGN_OR_RAISE(auto ts_output, ColumnDataOutput::Make(schema->field(0)->type()));
+    ARROW_ASSIGN_OR_RAISE(auto vs_output, ColumnDataOutput::Make(schema->field(1)->type()));
+    ARROW_ASSIGN_OR_RAISE(auto ts, ts_output.prepare(reader.size()));
+    ARROW_ASSIGN_OR_RAISE(auto vs, vs_output.prepare(reader.size()));
+    ARROW_RETURN_NOT_OK(decodeBlocksParallel(reader, threads, [&](size_t k, size_t offset) {
+        return reader.decodeBlock(k, ts.subspan(offset), vs.subspan(offset));
+    }));
+    ts_output.commit(reader.size());
+    vs_output.commit(reader.size());
+
+    ARROW_ASSIGN_OR_RAISE(auto ts_column_data, ts_output.finish());
+    ARROW_ASSIGN_OR_RAISE(auto vs_column_data, vs_output.finish());
+    return arrow::RecordBatch::Make(schema, ts_column_data->length, {ts_column_data, vs_column_data});
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializePairsBatchParallel(
+        const std::shared_ptr<arrow::Buffer> &data,
+        size_t threads = defaultThreadsNumber()
+) {
+    return deserializePairsBatchParallel(toStringView(data), threads);
+}
+
+// Decode `columns` (indices of the schema fields, all of them if empty) of a multi-column batch
+// serialized with `serializeMultiColumnBatch`.
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeMultiColumnBatch(
+        std::string_view data,
+        const std::vector<int> &columns = {}
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::MULTI_COLUMN));
+    ARROW_ASSIGN_OR_RAISE(auto codecs, takeValuesCodecTags(schema));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+
+    ARROW_ASSIGN_OR_RAISE(auto container, BlocksContainer::Make(view.payload));
+    const auto &blocks = container.blocks();
+    if (blocks.size() != static_cast<size_t>(schema->num_fields())) {
+        return arrow::Status::SerializationError("Expected ", schema->num_fields(), " column streams, got: ",
+                                                 blocks.size(), ".");
+    }
+
+    std::vector<int> selected = columns;
+    if (selected.empty()) {
+        for (int i = 0; i < schema->num_fields(); i++) {
+            selected.push_back(i);
+        }
+    }
+
+    int64_t rows = blocks.empty() ? 0 : blocks[0].count;
+    arrow::FieldVector fields;
+    std::vector<std::shared_ptr<arrow::ArrayData>> columns_data;
+    for (int i: selected) {
+        if (i < 0 || i >= schema->num_fields()) {
+            return arrow::Status::IndexError("Column ", i, " is out of range of ", schema->num_fields(), ".");
+        }
+        ARROW_ASSIGN_OR_RAISE(auto output, ColumnDataOutput::Make(schema->field(i)->type()));
+        ARROW_ASSIGN_OR_RAISE(auto out, output.prepare(blocks[i].count));
+        size_t decoded = decodeColumnStream(container.blockData(i), i == 0, out, codecs[i], scale);
+        if (decoded != blocks[i].count || static_cast<int64_t>(decoded) != rows) {
+            return arrow::Status::SerializationError("Column ", i, " has ", decoded, " entities instead of ",
+                                                     rows, ".");
+        }
+        output.commit(decoded);
+        ARROW_ASSIGN_OR_RAISE(auto column_data, output.finish());
+        fields.push_back(schema->field(i));
+        columns_data.push_back(std::move(column_data));
+    }
+
+    return arrow::RecordBatch::Make(arrow::schema(fields, schema->metadata()), rows, columns_data);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeMultiColumnBatch(
+        const std::string &data,
+        const std::vector<int> &columns = {}
+) {
+    return deserializeMultiColumnBatch(std::string_view(data), columns);
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeMultiColumnBatch(
+        const std::shared_ptr<arrow::Buffer> &data,
+        const std::vector<int> &columns = {}
+) {
+    return deserializeMultiColumnBatch(toStringView(data), columns);
+}
+
+// Directory of a container serialized with `serializeSeriesContainer`: keys, sizes and time bounds
+// of its series sorted by key (e.g. to choose the series to decode).
+arrow::Result<std::vector<SeriesInfo>> readSeriesDirectory(std::string_view data) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    ARROW_RETURN_NOT_OK(takeLayoutTag(view.schema, BatchLayout::SERIES));
+    ARROW_ASSIGN_OR_RAISE(auto container, SeriesContainer::Make(view.payload));
+    return container.series();
+}
+
+// Decode the series of `keys` (all the series in the key order when empty) of a container serialized
+// with `serializeSeriesContainer` on up to `threads` threads. Only the chosen series are read.
+arrow::Result<std::vector<std::pair<uint64_t, std::shared_ptr<arrow::RecordBatch>>>> deserializeSeriesContainer(
+        std::string_view data,
+        const std::vector<uint64_t> &keys = {},
+        size_t threads = 1
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::SERIES));
+    ARROW_ASSIGN_OR_RAISE(auto scale, takeTimestampsScaleTag(schema, 0));
+    ARROW_ASSIGN_OR_RAISE(auto version, takeFormatVersionTag(schema));
+    if (version != FormatVersion::COUNTED) {
+        return arrow::Status::SerializationError("Series container of format version ",
+                                                 static_cast<int>(version), ".");
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto container, SeriesContainer::Make(view.payload));
+    std::vector<size_t> selected;
+    if (keys.empty()) {
+        selected.resize(container.series().size());
+        std::iota(selected.begin(), selected.end(), 0);
+    }
+    for (uint64_t key: keys) {
+        auto i = container.find(key);
+        if (!i) {
+            return arrow::Status::KeyError("Series ", key, " not found in the series container.");
+        }
+        selected.push_back(*i);
+    }
+
+    std::vector<arrow::Result<std::shared_ptr<arrow::RecordBatch>>> batches(selected.size());
+    parallelFor(selected.size(), threads, [&](size_t k) {
+        batches[k] = [&]() -> arrow::Result<std::shared_ptr<arrow::RecordBatch>> {
+            const auto &info = container.series()[selected[k]];
+            auto series_data = container.seriesData(selected[k]);
+            if (info.count > series_data.size() * 8 + 1) {
+                return arrow::Status::SerializationError("Series ", info.key, " of ", info.count,
+                                                         " points doesn't fit ", series_data.size(), " bytes.");
+            }
+            ARROW_ASSIGN_OR_RAISE(auto ts_output, ColumnDataOutput::Make(schema->field(0)->type()));
+            ARROW_ASSIGN_OR_RAISE(auto vs_output, ColumnDataOutput::Make(schema->field(1)->type()));
+            BitReader br(series_data);
+            PairsDecoder d(br, scale);
+            ARROW_RETURN_NOT_OK(deserializeCountedPairEntities(d, info.count, ts_output, vs_output));
+            ARROW_ASSIGN_OR_RAISE(auto ts_column_data, ts_output.finish());
+            ARROW_ASSIGN_OR_RAISE(auto vs_column_data, vs_output.finish());
+            return arrow::RecordBatch::Make(schema, ts_column_data->length, {ts_column_data, vs_column_data});
+        }();
+    });
+
+    std::vector<std::pair<uint64_t, std::shared_ptr<arrow::RecordBatch>>> series;
+    series.reserve(selected.size());
+    for (size_t k = 0; k < selected.size(); k++) {
+        ARROW_ASSIGN_OR_RAISE(auto batch, std::move(batches[k]));
+        series.emplace_back(container.series()[selected[k]].key, std::move(batch));
+    }
+    return series;
+}
+
+arrow::Result<std::vector<std::pair<uint64_t, std::shared_ptr<arrow::RecordBatch>>>> deserializeSeriesContainer(
+        const std::shared_ptr<arrow::Buffer> &data,
+        const std::vector<uint64_t> &keys = {},
+        size_t threads = 1
+) {
+    return deserializeSeriesContainer(toStringView(data), keys, threads);
+}
+
+// Decode a block written by `encodeAdaptiveBlock` into `out` (of the block size).
+arrow::Result<size_t> decodeAdaptiveBlock(
+        std::span<const uint8_t> data,
+        bool is_timestamp,
+        const GeneralPurposeCodecs &codecs,
+        std::span<uint64_t> out
+) {
+    if (data.empty()) {
+        return arrow::Status::SerializationError("Adaptive block is empty.");
+    }
+    auto codec = static_cast<BlockCodec>(data[0]);
+    auto payload = data.subspan(1);
+    switch (codec) {
+        case BlockCodec::GORILLA:
+            return decodeColumnStream(payload, is_timestamp, out);
+        case BlockCodec::DELTA:
+            return decodeDeltaBlock(payload, out);
+        case BlockCodec::RLE:
+            return decodeRleBlock(payload, out);
+        case BlockCodec::RAW:
+            return decodeRawBlock(payload, out);
+        case BlockCodec::REGULAR:
+            return decodeRegularBlock(payload, out);
+        case BlockCodec::GORILLA_LZ4:
+        case BlockCodec::GORILLA_ZSTD: {
+            auto *general_purpose = codecs.get(codec);
+            if (general_purpose == nullptr) {
+                return arrow::Status::NotImplemented("General-purpose codec of the block is not available.");
+            }
+            if (payload.size() < sizeof(uint32_t)) {
+                return arrow::Status::SerializationError("Adaptive block is truncated.");
+            }
+            std::vector<uint8_t> stream(readLittleEndian<uint32_t>(payload.data()));
+            ARROW_RETURN_NOT_OK(general_purpose->Decompress(
+                    static_cast<int64_t>(payload.size() - sizeof(uint32_t)), payload.data() + sizeof(uint32_t),
+                    static_cast<int64_t>(stream.size()), stream.data()).status());
+            return decodeColumnStream(stream, is_timestamp, out);
+        }
+    }
+    return arrow::Status::SerializationError("Unknown block codec: ", static_cast<int>(data[0]), ".");
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatchAdaptive(
+        std::string_view data
+) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    auto schema = view.schema;
+    ARROW_RETURN_NOT_OK(takeLayoutTag(schema, BatchLayout::ADAPTIVE));
+    auto column_type = schema->field(0)->type();
+    bool is_timestamp = column_type->id() == arrow::Type::TIMESTAMP;
+
+    ARROW_ASSIGN_OR_RAISE(auto container, BlocksContainer::Make(view.payload, adaptiveBlockPoints));
+    auto codecs = GeneralPurposeCodecs::Make();
+    ARROW_ASSIGN_OR_RAISE(auto output, ColumnDataOutput::Make(column_type));
+    ARROW_ASSIGN_OR_RAISE(auto out, output.prepare(container.size()));
+    size_t offset = 0;
+    for (size_t k = 0; k < container.blocks().size(); k++) {
+        size_t count = container.blocks()[k].count;
+        ARROW_ASSIGN_OR_RAISE(auto decoded, decodeAdaptiveBlock(container.blockData(k), is_timestamp, codecs,
+                                                                out.subspan(offset, count)));
+        if (decoded != count) {
+            return arrow::Status::SerializationError("Block ", k, " has ", decoded, " points instead of ", count, ".");
+        }
+        offset += count;
+    }
+    output.commit(container.size());
+
+    ARROW_ASSIGN_OR_RAISE(auto column_data, output.finish());
+    return arrow::RecordBatch::Make(schema, column_data->length, {column_data});
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatchAdaptive(
+        const std::string &data
+) {
+    return deserializeSingleColumnBatchAdaptive(std::string_view(data));
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> deserializeSingleColumnBatchAdaptive(
+        const std::shared_ptr<arrow::Buffer> &data
+) {
+    return deserializeSingleColumnBatchAdaptive(toStringView(data));
+}
+
+// Value (as passed to the codecs, see `toU64`) of row `row` of a column serialized with
+// `serializeSingleColumnBatchAdaptive`. Only the block holding the row is read, `REGULAR` blocks
+// are not decoded at all.
+arrow::Result<uint64_t> readAdaptiveColumnValue(std::string_view data, size_t row) {
+    ARROW_ASSIGN_OR_RAISE(auto view, parseSerializedBatch(data));
+    ARROW_RETURN_NOT_OK(takeLayoutTag(view.schema, BatchLayout::ADAPTIVE));
+    bool is_timestamp = view.schema->field(0)->type()->id() == arrow::Type::TIMESTAMP;
+
+    ARROW_ASSIGN_OR_RAISE(auto container, BlocksContainer::Make(view.payload, adaptiveBlockPoints));
+    for (size_t k = 0; k < container.blocks().size(); k++) {
+        size_t count = container.blocks()[k].count;
+        if (row >= count) {
+            row -= count;
+            continue;
+        }
+        auto block = container.blockData(k);
+        if (!block.empty() && block[0] == static_cast<uint8_t>(BlockCodec::REGULAR)) {
+            return regularBlockValue(block.subspan(1), row);
+        }
+        std::vector<uint64_t> values(count);
+        ARROW_ASSIGN_OR_RAISE(auto decoded, decodeAdaptiveBlock(block, is_timestamp, GeneralPurposeCodecs::Make(),
+                                                                values));
+        if (decoded != count) {
+            return arrow::Status::SerializationError("Block ", k, " has ", decoded, " points instead of ", count, ".");
+        }
+        return values[row];
+    }
+    return arrow::Status::IndexError("Row is out of range of ", container.size(), " rows.");
+}
 // ---------- APACHE ARROW HELPERS --------------
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <arrow/csv/api.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
+#include <arrow/visit_type_inline.h>
+#include <arrow/util/compression.h>
 
 #include <sstream>
 #include "gorilla.h"
@@ -124,6 +124,41 @@ void read() {
     std::cout << "Read bits from the file." << std::endl;
 }
 
+void readFromMemory() {
+    std::ifstream inFile(CUSTOM_READ_WRITE_FILE_NAME, std::ios::binary);
+    if (!inFile.is_open()) {
+        std::cerr << "Failed to open input file." << std::endl;
+        exit(1);
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+    inFile.close();
+    BitReader br(std::span<const uint8_t>(bytes.data(), bytes.size()));
+
+    // Expected 1101.
+    if (br.peekBits(4) != 0b1101 || br.readBits(4) != 0b1101) {
+        std::cerr << "Unexpected bits peeked from memory." << std::endl;
+        exit(1);
+    }
+    // Skip 0100.
+    br.skipBits(4);
+    // Expected 11100010 10111111 11101000 01100111 01000000 11110101.
+    uint64_t tail = br.readBits(48);
+    if (tail != 0xE2BFE86740F5) {
+        std::cerr << "Unexpected bits read from memory: " << std::bitset<48>(tail) << std::endl;
+        exit(1);
+    }
+    if (br.bitPosition() != 56) {
+        std::cerr << "Unexpected bit position: " << br.bitPosition() << std::endl;
+        exit(1);
+    }
+    // Reading past the end yields zeros.
+    if (br.readBits(64) != 0) {
+        std::cerr << "Expected zeros past the end of the data." << std::endl;
+        exit(1);
+    }
+    std::cout << "Read bits from memory." << std::endl;
+}
+
 // To run execute:
 // `cmake . && make bit_wr_test && ./bit_wr_test`
 //
@@ -137,4 +172,5 @@ void read() {
 int main() {
     write();
     read();
+    readFromMemory();
 }
\ No newline at end of file
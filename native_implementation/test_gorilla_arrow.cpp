@@ -31,6 +31,19 @@ arrow::Status testDeserializationScenarioWithoutKnownSchemaForSingleColumnBatch(
     auto batch_deserialized = batch_deserialized_res.ValueOrDie();
 
     compareTwoBatches(batch, batch_deserialized, 1);
+
+    // Segments encoded and decoded in parallel.
+    ARROW_ASSIGN_OR_RAISE(auto serialized_segments, serializeSingleColumnBatchParallel(batch, 32, 4));
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_from_segments,
+                          deserializeSingleColumnBatchParallel(serialized_segments, 4));
+    compareTwoBatches(batch, batch_deserialized_from_segments, 1);
+
+    // Chimp codecs (used for values columns only).
+    for (auto codec : {ValuesCodec::CHIMP, ValuesCodec::CHIMP128}) {
+        ARROW_ASSIGN_OR_RAISE(auto serialized_chimp, serializeSingleColumnBatch(batch, codec));
+        ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_chimp, deserializeSingleColumnBatch(serialized_chimp));
+        compareTwoBatches(batch, batch_deserialized_chimp, 1);
+    }
     return arrow::Status::OK();
 }
 
@@ -51,6 +64,74 @@ arrow::Status testDeserializationScenarioWithoutKnownSchemaPairs(
     auto batch_deserialized = batch_deserialized_res.ValueOrDie();
 
     compareTwoBatches(batch, batch_deserialized, 2);
+
+    // Zero-copy serialization into a buffer and deserialization from it.
+    ARROW_ASSIGN_OR_RAISE(auto serialized_buffer, serializePairsBatchToBuffer(batch));
+    if (serialized_buffer->ToString() != serialized_batch) {
+        std::cerr << "Serialization into a buffer differs from serialization into a string." << std::endl;
+        exit(1);
+    }
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_from_buffer, deserializePairsBatch(serialized_buffer));
+    compareTwoBatches(batch, batch_deserialized_from_buffer, 2);
+
+    // Split layout, decoded on 2 threads and timestamps only.
+    ARROW_ASSIGN_OR_RAISE(auto serialized_split, serializePairsBatchToBuffer(batch, PairsLayout::SPLIT));
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_from_split,
+                          deserializePairsBatch(serialized_split, PairsLayout::SPLIT, 2));
+    compareTwoBatches(batch, batch_deserialized_from_split, 2);
+    ARROW_ASSIGN_OR_RAISE(auto batch_ts_deserialized, deserializePairsBatchTimestamps(serialized_split));
+    compareTwoBatches(batch_ts, batch_ts_deserialized, 1);
+    auto truncated_split = arrow::SliceBuffer(serialized_split, 0, serialized_split->size() - 1);
+    if (deserializePairsBatch(truncated_split, PairsLayout::SPLIT).ok()
+        || deserializePairsBatchTimestamps(truncated_split).ok()) {
+        std::cerr << "Truncated split pairs data is deserialized." << std::endl;
+        exit(1);
+    }
+
+    // Segments encoded and decoded in parallel.
+    ARROW_ASSIGN_OR_RAISE(auto serialized_segments, serializePairsBatchParallel(batch, 32, 4));
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_from_segments, deserializePairsBatchParallel(serialized_segments, 4));
+    compareTwoBatches(batch, batch_deserialized_from_segments, 2);
+    if (serializeSingleColumnBatchParallel(batch_ts, 0).ok() || serializePairsBatchParallel(batch, 0).ok()) {
+        std::cerr << "Segments of zero points are accepted." << std::endl;
+        exit(1);
+    }
+
+    // Payloads are read only by the deserializers of their layout.
+    ARROW_ASSIGN_OR_RAISE(auto serialized_ts_segments, serializeSingleColumnBatchParallel(batch_ts, 32, 4));
+    ARROW_ASSIGN_OR_RAISE(auto serialized_adaptive, serializeSingleColumnBatchAdaptive(batch_ts));
+    if (deserializeSingleColumnBatch(serialized_ts_segments).ok()
+        || deserializeSingleColumnBatch(serialized_adaptive).ok()
+        || deserializePairsBatch(serialized_segments).ok() || deserializePairsBatch(serialized_split).ok()
+        || deserializePairsBatch(serialized_buffer, PairsLayout::SPLIT).ok()
+        || deserializePairsBatchParallel(serialized_buffer).ok()) {
+        std::cerr << "Payload of another layout is deserialized." << std::endl;
+        exit(1);
+    }
+    return arrow::Status::OK();
+}
+
+arrow::Status testDeserializationScenarioMultiColumn(
+        const std::shared_ptr<arrow::RecordBatch>& batch_ts,
+        const std::shared_ptr<arrow::RecordBatch>& batch_vs
+) {
+    auto batch_vs_u64 = getTestDataBatchVs(getTestDataVecValues<uint64_t>()).ValueOrDie();
+    auto batch = mergeRecordBatches(getTestDataBatchPairs(batch_ts, batch_vs), batch_vs_u64);
+    ARROW_ASSIGN_OR_RAISE(auto serialized_batch, serializeMultiColumnBatch(batch));
+
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized, deserializeMultiColumnBatch(serialized_batch));
+    compareTwoBatches(batch, batch_deserialized, 3);
+
+    ARROW_ASSIGN_OR_RAISE(auto serialized_chimp, serializeMultiColumnBatch(batch, ValuesCodec::CHIMP128));
+    ARROW_ASSIGN_OR_RAISE(auto batch_deserialized_chimp, deserializeMultiColumnBatch(serialized_chimp));
+    compareTwoBatches(batch, batch_deserialized_chimp, 3);
+
+    // Only the last values column is materialized.
+    ARROW_ASSIGN_OR_RAISE(auto batch_subset, deserializeMultiColumnBatch(serialized_batch, {2}));
+    if (batch_subset->num_columns() != 1 || !batch_subset->column(0)->Equals(batch->column(2))) {
+        std::cerr << "Multi-column batch subset not equal." << std::endl;
+        exit(1);
+    }
     return arrow::Status::OK();
 }
 
@@ -78,6 +159,11 @@ void testDeserializationScenarioWithoutKnownSchema() {
         std::cerr << "Arrow throw an error on pairs deserialization." << std::endl;
         exit(1);
     }
+    res = testDeserializationScenarioMultiColumn(batch_ts, batch_vs);
+    if (!res.ok()) {
+        std::cerr << "Arrow throw an error on multi-column deserialization: " << res << std::endl;
+        exit(1);
+    }
 }
 
 void testCompressDecompressPairs() {
@@ -111,7 +197,7 @@ void testCompressDecompressPairs() {
         exit(1);
     }
 
-    for (int i = 0; i < data_vec.size(); i++) {
+    for (size_t i = 0; i < data_vec.size(); i++) {
         auto [expected_time, expected_value] = data_vec[i];
         auto [actual_time, actual_value] = data_vec_des[i];
         if (expected_time != actual_time) {
@@ -125,6 +211,659 @@ void testCompressDecompressPairs() {
     }
 }
 
+void testBulkDecodePairs() {
+    auto data_vec = getTestDataVec<uint64_t>(10 * DEFAULT_TEST_DATA_LEN);
+    std::stringstream stream;
+    {
+        auto bw = std::make_shared<BitWriter>(stream);
+        PairsCompressor c(bw);
+        for (auto data_pair : data_vec) {
+            c.compress(std::make_pair(data_pair.time, data_pair.value + 1000));
+        }
+        c.finish();
+    }
+    std::string bytes = stream.str();
+
+    auto br = std::make_shared<BitReader>(
+            std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size()));
+    PairsDecompressor d(br);
+    // Decode with a chunk size that doesn't divide the number of points.
+    std::vector<uint64_t> ts(data_vec.size() + 7);
+    std::vector<uint64_t> vs(data_vec.size() + 7);
+    size_t decoded = 0;
+    size_t n;
+    do {
+        size_t chunk = std::min<size_t>(7, ts.size() - decoded);
+        n = d.decodeInto(std::span(ts).subspan(decoded, chunk), std::span(vs).subspan(decoded, chunk));
+        decoded += n;
+    } while (n > 0);
+
+    if (decoded != data_vec.size()) {
+        std::cerr << "Bulk decode. Expected: " << data_vec.size() << " pairs, got: " << decoded << "." << std::endl;
+        exit(1);
+    }
+    for (size_t i = 0; i < data_vec.size(); i++) {
+        if (ts[i] != data_vec[i].time || vs[i] != data_vec[i].value + 1000) {
+            std::cerr << "Bulk decode. Pairs not equal on i = " << i << "." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void testNarrowValuesCodec() {
+    auto data_vec = getTestDataVec<uint32_t>(10 * DEFAULT_TEST_DATA_LEN);
+    BitWriter bw;
+    PairsEncoder<BitWriter, uint32_t> encoder(bw);
+    for (auto data_pair : data_vec) {
+        encoder.compress(std::make_pair(data_pair.time, data_pair.value));
+    }
+    encoder.finish();
+
+    BitReader br(bw.data(), bw.size());
+    PairsDecoder<BitReader, uint32_t> decoder(br);
+    for (size_t i = 0; i < data_vec.size(); i++) {
+        auto pair = decoder.next();
+        if (!pair || pair->first != data_vec[i].time || pair->second != data_vec[i].value) {
+            std::cerr << "Narrow values codec. Pairs not equal on i = " << i << "." << std::endl;
+            exit(1);
+        }
+    }
+    if (decoder.next()) {
+        std::cerr << "Narrow values codec. Expected the end of the series." << std::endl;
+        exit(1);
+    }
+}
+
+void testIntegerCodec() {
+    // Empty series, one value, full miniblocks and a tail, deltas of all widths up to 64 bits
+    // and noise (packed as plain values).
+    for (size_t n : {size_t(0), size_t(1), INTEGER_MINIBLOCK_SIZE, 3 * INTEGER_MINIBLOCK_SIZE + 5}) {
+        std::vector<uint64_t> values(n);
+        for (size_t i = 0; i < n; i++) {
+            if (i >= 2 * INTEGER_MINIBLOCK_SIZE) {
+                values[i] = (i * 7919) % 251;
+            } else {
+                values[i] = i % 64 == 63 ? UINT64_MAX : 1000 + i * 7 + (uint64_t(1) << (i % 64)) * (i % 2);
+            }
+        }
+        BitWriter bw;
+        IntegerEncoder encoder(bw);
+        for (auto value : values) {
+            encoder.compress(value);
+        }
+        encoder.finish();
+        if (bw.size() > IntegerEncoder<>::maxCompressedSize(n)) {
+            std::cerr << "Integer codec. Compressed size is over the bound for n = " << n << "." << std::endl;
+            exit(1);
+        }
+
+        BitReader br(bw.data(), bw.size());
+        IntegerDecoder decoder(br);
+        std::vector<uint64_t> decoded(n + 1);
+        if (decoder.decodeInto(decoded) != n || !std::equal(values.begin(), values.end(), decoded.begin())) {
+            std::cerr << "Integer codec. Values not equal for n = " << n << "." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void testIntegerKernels() {
+    auto scalar = integerKernels(SimdLevel::SCALAR);
+    std::vector<uint8_t> packed(INTEGER_MINIBLOCK_SIZE * 8 + INTEGER_PACKED_PADDING);
+    uint64_t random = 88172645463325252ULL;
+    for (auto &byte : packed) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        byte = static_cast<uint8_t>(random);
+    }
+
+    // Every instruction set the CPU supports against the scalar kernels, on all widths and tails.
+    for (int level = 1; level <= static_cast<int>(detectSimdLevel()); level++) {
+        auto kernels = integerKernels(static_cast<SimdLevel>(level));
+        for (int width = 1; width <= 64; width++) {
+            for (size_t n : {size_t(0), size_t(1), size_t(2), size_t(7), size_t(9), size_t(17), INTEGER_MINIBLOCK_SIZE}) {
+                std::vector<uint64_t> expected(n), actual(n);
+                scalar.unpack(packed.data(), n, width, expected.data());
+                kernels.unpack(packed.data(), n, width, actual.data());
+                if (expected != actual) {
+                    std::cerr << "Integer kernels. Unpacked values not equal for level = " << level
+                              << ", width = " << width << ", n = " << n << "." << std::endl;
+                    exit(1);
+                }
+                scalar.prefix_sum(width * 12345, expected.data(), n);
+                kernels.prefix_sum(width * 12345, actual.data(), n);
+                if (expected != actual) {
+                    std::cerr << "Integer kernels. Prefix sums not equal for level = " << level
+                              << ", width = " << width << ", n = " << n << "." << std::endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+void testBlocksDecodeRange() {
+    auto data_vec = getTestDataVec<uint64_t>(10 * DEFAULT_TEST_DATA_LEN);
+    BlockPairsWriter writer(64);
+    for (auto data_pair : data_vec) {
+        writer.append(data_pair.time, data_pair.value);
+    }
+    auto bytes = writer.finish();
+    auto reader = BlockPairsReader::Make(bytes).ValueOrDie();
+    if (reader.size() != data_vec.size()) {
+        std::cerr << "Blocks. Expected: " << data_vec.size() << " points, got: " << reader.size() << "." << std::endl;
+        exit(1);
+    }
+    for (size_t size : {size_t(0), bytes.size() / 2, bytes.size() - 1}) {
+        if (BlockPairsReader::Make(std::span(bytes).first(size)).ok()) {
+            std::cerr << "Blocks. Truncated container of " << size << " bytes is read." << std::endl;
+            exit(1);
+        }
+    }
+    auto corrupted = bytes;
+    storeLittleEndian(corrupted.data() + bytes.size() - blocksFooterSize(reader.blocks().size()) + 8,
+                      uint32_t(0xFFFFFFF0));
+    if (BlockPairsReader::Make(corrupted).ok()) {
+        std::cerr << "Blocks. Container with a block count above its size is read." << std::endl;
+        exit(1);
+    }
+
+    uint64_t t_from = data_vec[data_vec.size() / 3].time;
+    uint64_t t_to = data_vec[data_vec.size() / 2].time;
+    std::vector<uint64_t> ts;
+    std::vector<uint64_t> vs;
+    reader.decodeRange(t_from, t_to, ts, vs);
+
+    size_t j = 0;
+    for (auto data_pair : data_vec) {
+        if (data_pair.time < t_from || t_to < data_pair.time) {
+            continue;
+        }
+        if (j >= ts.size() || ts[j] != data_pair.time || vs[j] != data_pair.value) {
+            std::cerr << "Blocks. Range points not equal on j = " << j << "." << std::endl;
+            exit(1);
+        }
+        j++;
+    }
+    if (j != ts.size()) {
+        std::cerr << "Blocks. Expected: " << j << " points in range, got: " << ts.size() << "." << std::endl;
+        exit(1);
+    }
+}
+
+void testBlocksAggregates() {
+    auto data_vec = getTestDataVec<uint64_t>(10 * DEFAULT_TEST_DATA_LEN);
+    BlockPairsWriter writer(64);
+    BitWriter bw;
+    PairsEncoder encoder(bw);
+    for (auto data_pair : data_vec) {
+        writer.append(data_pair.time, data_pair.value);
+        encoder.compress({data_pair.time, data_pair.value});
+    }
+    encoder.finish();
+    auto bytes = writer.finish();
+    auto reader = BlockPairsReader::Make(bytes).ValueOrDie();
+
+    uint64_t t_from = data_vec[data_vec.size() / 3].time;
+    uint64_t t_to = data_vec[data_vec.size() / 2].time;
+    Aggregates<uint64_t> expected;
+    for (auto data_pair : data_vec) {
+        if (t_from <= data_pair.time && data_pair.time <= t_to) {
+            expected.add(data_pair.time, data_pair.value);
+        }
+    }
+
+    BitReader br(std::span(bw.data(), bw.size()));
+    PairsDecoder decoder(br);
+    auto from_stream = aggregatePairs(decoder, t_from, t_to);
+    auto from_blocks = reader.aggregate(t_from, t_to);
+    for (const auto &actual : {from_stream, from_blocks}) {
+        if (actual.count != expected.count || actual.min != expected.min || actual.max != expected.max
+            || actual.sum != expected.sum || actual.first != expected.first || actual.last != expected.last) {
+            std::cerr << "Aggregates not equal. Expected count: " << expected.count << ", got: " << actual.count
+                      << "." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void testAdaptiveBlocks() {
+    // Blocks of constant, linear, random and test values.
+    const size_t block_points = 64;
+    std::mt19937_64 gen(1);
+    std::vector<uint64_t> vs_vec;
+    for (size_t i = 0; i < block_points; i++) {
+        vs_vec.push_back(7);
+    }
+    for (size_t i = 0; i < block_points; i++) {
+        vs_vec.push_back(1000 + 3 * i);
+    }
+    for (size_t i = 0; i < block_points; i++) {
+        vs_vec.push_back(gen());
+    }
+    auto test_vs_vec = getTestDataVecValues<uint64_t>();
+    vs_vec.insert(vs_vec.end(), test_vs_vec.begin(), test_vs_vec.end());
+    auto batch = getTestDataBatchVs(vs_vec).ValueOrDie();
+
+    auto serialized_batch = serializeSingleColumnBatchAdaptive(batch, block_points).ValueOrDie();
+    auto batch_deserialized = deserializeSingleColumnBatchAdaptive(serialized_batch).ValueOrDie();
+    compareTwoBatches(batch, batch_deserialized, 1);
+
+    auto payload = parseSerializedBatch(toStringView(serialized_batch)).ValueOrDie().payload;
+    auto container = BlocksContainer::Make(payload, adaptiveBlockPoints).ValueOrDie();
+    if (container.blockData(0)[0] != static_cast<uint8_t>(BlockCodec::DELTA)
+        || container.blockData(2)[0] != static_cast<uint8_t>(BlockCodec::RAW)) {
+        std::cerr << "Adaptive blocks. Unexpected codecs of constant and random blocks." << std::endl;
+        exit(1);
+    }
+    auto corrupted = serialized_batch->ToString();
+    storeLittleEndian(reinterpret_cast<uint8_t *>(corrupted.data()) + corrupted.size()
+                      - blocksFooterSize(container.blocks().size()) + 8, uint32_t(MAX_ADAPTIVE_BLOCK_POINTS + 1));
+    if (deserializeSingleColumnBatchAdaptive(corrupted).ok()) {
+        std::cerr << "Adaptive blocks. Block with too many points is read." << std::endl;
+        exit(1);
+    }
+    if (serializeSingleColumnBatchAdaptive(batch, 0).ok()) {
+        std::cerr << "Adaptive blocks. Blocks of zero points are accepted." << std::endl;
+        exit(1);
+    }
+}
+
+void testRegularBlocks() {
+    // Blocks of a 10 s series and a block with a gap.
+    const size_t block_points = 64;
+    std::vector<int64_t> ts_vec;
+    for (size_t i = 0; i < 3 * block_points; i++) {
+        ts_vec.push_back(1700000000000000 + static_cast<int64_t>(i + (i >= 2 * block_points + 5)) * 10000000);
+    }
+    auto type = arrow::timestamp(arrow::TimeUnit::MICRO);
+    arrow::TimestampBuilder builder(type, arrow::default_memory_pool());
+    if (!builder.AppendValues(ts_vec).ok()) {
+        std::cerr << "Regular blocks. Unable to build the timestamps column." << std::endl;
+        exit(1);
+    }
+    auto array = builder.Finish().ValueOrDie();
+    auto batch = arrow::RecordBatch::Make(arrow::schema({arrow::field("Time", type)}), array->length(), {array});
+
+    auto serialized_batch = serializeSingleColumnBatchAdaptive(batch, block_points).ValueOrDie();
+    auto batch_deserialized = deserializeSingleColumnBatchAdaptive(serialized_batch).ValueOrDie();
+    compareTwoBatches(batch, batch_deserialized, 1);
+    // Runs of regular timestamps in a plain stream of any format version.
+    for (auto version : {FormatVersion::END_MARKER, FormatVersion::COUNTED}) {
+        auto serialized_stream = serializeSingleColumnBatch(batch, ValuesCodec::AUTO, version).ValueOrDie();
+        compareTwoBatches(batch, deserializeSingleColumnBatch(serialized_stream).ValueOrDie(), 1);
+    }
+
+    auto payload = parseSerializedBatch(toStringView(serialized_batch)).ValueOrDie().payload;
+    auto container = BlocksContainer::Make(payload, adaptiveBlockPoints).ValueOrDie();
+    if (container.blockData(0)[0] != static_cast<uint8_t>(BlockCodec::REGULAR)
+        || container.blockData(2)[0] == static_cast<uint8_t>(BlockCodec::REGULAR)) {
+        std::cerr << "Regular blocks. Unexpected codecs of regular and irregular blocks." << std::endl;
+        exit(1);
+    }
+    for (size_t i : {size_t(0), block_points + 3, 3 * block_points - 1}) {
+        auto value = readAdaptiveColumnValue(toStringView(serialized_batch), i).ValueOrDie();
+        if (value != static_cast<uint64_t>(ts_vec[i])) {
+            std::cerr << "Regular blocks. Values not equal on i = " << i << "." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void testOpenPairsStream() {
+    // Readers decode snapshots while the writer keeps appending, every snapshot is a prefix of the series.
+    const size_t points = 200000;
+    std::vector<uint64_t> ts_vec(points), vs_vec(points);
+    for (size_t i = 0; i < points; i++) {
+        ts_vec[i] = 1700000000 + i * 10 + (i % 7 == 0 ? i % 3 : 0);
+        vs_vec[i] = i % 11 == 0 ? i * 1000003 : 42;
+    }
+    OpenPairsStream stream;
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> readers;
+    for (size_t k = 0; k < 2; k++) {
+        readers.emplace_back([&] {
+            size_t last_count = 0;
+            while (last_count < points && !failed) {
+                std::vector<uint64_t> ts, vs;
+                size_t count = stream.read(ts, vs);
+                if (count < last_count || !std::equal(ts.begin(), ts.end(), ts_vec.begin())
+                    || !std::equal(vs.begin(), vs.end(), vs_vec.begin())) {
+                    failed = true;
+                }
+                last_count = count;
+            }
+        });
+    }
+    for (size_t i = 0; i < points; i += 100) {
+        if (i % 1000 == 0) {
+            stream.appendBatch(std::span(ts_vec).subspan(i, 100), std::span(vs_vec).subspan(i, 100));
+            continue;
+        }
+        for (size_t j = i; j < i + 100; j++) {
+            stream.append(ts_vec[j], vs_vec[j]);
+        }
+    }
+    for (auto &reader: readers) {
+        reader.join();
+    }
+    if (failed) {
+        std::cerr << "Open pairs stream. Snapshot points not equal to the appended ones." << std::endl;
+        exit(1);
+    }
+}
+
+void testAppendToSerialized() {
+    auto batch_ts = getTestDataBatchTs(getTestDataVecTs(5000)).ValueOrDie();
+    auto batch_vs = getTestDataBatchVs(getTestDataVecValues<double>(5000)).ValueOrDie();
+    auto batch = getTestDataBatchPairs(batch_ts, batch_vs);
+    auto expected = serializePairsBatch(batch, PairsLayout::INTERLEAVED, FormatVersion::APPENDABLE).ValueOrDie();
+
+    // Appending in parts (starting from an empty batch) continues the series bit by bit.
+    auto serialized = serializePairsBatch(batch->Slice(0, 0), PairsLayout::INTERLEAVED,
+                                          FormatVersion::APPENDABLE).ValueOrDie();
+    for (auto [offset, length] : {std::pair(0, 1), std::pair(1, 999), std::pair(1000, 0), std::pair(1000, 4000)}) {
+        if (!appendTo(serialized, batch->Slice(offset, length)).ok()) {
+            std::cerr << "Append to serialized. Unable to append " << length << " points." << std::endl;
+            exit(1);
+        }
+        auto batch_deserialized = deserializePairsBatch(serialized).ValueOrDie();
+        compareTwoBatches(batch->Slice(0, offset + length), batch_deserialized, 2);
+    }
+    if (serialized != expected) {
+        std::cerr << "Append to serialized. Serialized data not equal to the one of the whole batch." << std::endl;
+        exit(1);
+    }
+    auto counted = serializePairsBatch(batch).ValueOrDie();
+    if (appendTo(counted, batch).ok()) {
+        std::cerr << "Append to serialized. Points are appended to a non-appendable batch." << std::endl;
+        exit(1);
+    }
+}
+
+void testPairsCheckpointIndex() {
+    const size_t n = 10000, points_per_checkpoint = 256;
+    auto ts_vec = getTestDataVecTs(n);
+    auto vs_vec = getTestDataVecValues<double>(n);
+    auto batch_ts = getTestDataBatchTs(ts_vec).ValueOrDie();
+    auto batch_vs = getTestDataBatchVs(vs_vec).ValueOrDie();
+    auto batch = getTestDataBatchPairs(batch_ts, batch_vs);
+    std::vector<size_t> rows = {0, 1, points_per_checkpoint - 1, points_per_checkpoint, 5 * points_per_checkpoint + 7,
+                                n - points_per_checkpoint, n - 1};
+    for (size_t i = 0; i < 100; i++) {
+        rows.push_back(i * 7919 % n);
+    }
+    auto check_row = [&](const std::string &name, std::pair<uint64_t, uint64_t> pair, size_t row) {
+        if (pair.first != ts_vec[row] || pair.second != toU64(vs_vec[row])) {
+            std::cerr << "Checkpoint index. " << name << ": row " << row << " not equal to the expected one."
+                      << std::endl;
+            exit(1);
+        }
+    };
+
+    // Index built from a serialized batch of every format, restored from its serialized form.
+    for (auto version : {FormatVersion::END_MARKER, FormatVersion::COUNTED, FormatVersion::APPENDABLE}) {
+        auto serialized = serializePairsBatch(batch, PairsLayout::INTERLEAVED, version).ValueOrDie();
+        auto built = buildPairsCheckpointIndex(serialized, points_per_checkpoint).ValueOrDie();
+        auto index = PairsCheckpointIndex::parse(built.serialize()).ValueOrDie();
+        if (index.count() != n || index.checkpoints().size() != n / points_per_checkpoint) {
+            std::cerr << "Checkpoint index. " << index.checkpoints().size() << " checkpoints of " << index.count()
+                      << " points." << std::endl;
+            exit(1);
+        }
+        for (size_t row : rows) {
+            check_row("Serialized batch", readPairsRow(serialized, index, row).ValueOrDie(), row);
+        }
+        if (readPairsRow(serialized, index, n).ok()) {
+            std::cerr << "Checkpoint index. Row out of range is read." << std::endl;
+            exit(1);
+        }
+        auto index_serialized = built.serialize();
+        index_serialized.pop_back();
+        if (PairsCheckpointIndex::parse(index_serialized).ok()) {
+            std::cerr << "Checkpoint index. Truncated index is parsed." << std::endl;
+            exit(1);
+        }
+    }
+
+    // Index built alongside the stream, read on from a seeked row.
+    BitWriter bw;
+    PairsEncoder<> c(bw);
+    PairsCheckpointIndex index(points_per_checkpoint);
+    for (size_t i = 0; i < n; i++) {
+        c.compress({ts_vec[i], toU64(vs_vec[i])});
+        index.add(c, bw.bitSize());
+    }
+    c.finish();
+    PairsRowReader reader(std::span(bw.data(), bw.size()), index);
+    for (size_t row : rows) {
+        if (!reader.seekToRow(row)) {
+            std::cerr << "Checkpoint index. Unable to seek to row " << row << "." << std::endl;
+            exit(1);
+        }
+        for (size_t i = row; i < std::min(n, row + 300); i++) {
+            check_row("Encoded stream", *reader.next(), i);
+        }
+    }
+}
+
+void testSeriesContainer() {
+    // Series of different lengths (one of them empty) under unordered keys.
+    std::vector<std::pair<uint64_t, std::shared_ptr<arrow::RecordBatch>>> series;
+    size_t separate_size = 0;
+    for (size_t k = 0; k < 200; k++) {
+        size_t n = k * 37 % 500;
+        auto batch_ts = getTestDataBatchTs(getTestDataVecTs(n)).ValueOrDie();
+        auto batch_vs = getTestDataBatchVs(getTestDataVecValues<double>(n)).ValueOrDie();
+        auto batch = getTestDataBatchPairs(batch_ts, batch_vs);
+        separate_size += serializePairsBatch(batch).ValueOrDie().size();
+        series.emplace_back(k * 0x9E3779B97F4A7C15, batch);
+    }
+    auto serialized = serializeSeriesContainer(series).ValueOrDie();
+    if (static_cast<size_t>(serialized->size()) >= separate_size) {
+        std::cerr << "Series container. " << serialized->size() << " bytes is not less than " << separate_size
+                  << " bytes of separate batches." << std::endl;
+        exit(1);
+    }
+
+    auto directory = readSeriesDirectory(toStringView(serialized)).ValueOrDie();
+    auto all = deserializeSeriesContainer(serialized, {}, 4).ValueOrDie();
+    if (directory.size() != series.size() || all.size() != series.size()) {
+        std::cerr << "Series container. " << all.size() << " series instead of " << series.size() << "." << std::endl;
+        exit(1);
+    }
+    for (size_t i = 0; i < all.size(); i++) {
+        auto it = std::find_if(series.begin(), series.end(), [&](const auto &s) {
+            return s.first == all[i].first;
+        });
+        if ((i > 0 && all[i - 1].first >= all[i].first) || it == series.end()) {
+            std::cerr << "Series container. Series " << all[i].first << " out of the key order." << std::endl;
+            exit(1);
+        }
+        compareTwoBatches(it->second, all[i].second, 2);
+        auto ts = std::static_pointer_cast<arrow::TimestampArray>(it->second->column(0));
+        auto [min_t, max_t] = std::minmax_element(ts->raw_values(), ts->raw_values() + ts->length());
+        if (ts->length() > 0 && (directory[i].min_t != static_cast<uint64_t>(*min_t)
+                                 || directory[i].max_t != static_cast<uint64_t>(*max_t))) {
+            std::cerr << "Series container. Time bounds of series " << all[i].first << " not equal." << std::endl;
+            exit(1);
+        }
+    }
+
+    // Subset is decoded in the requested order.
+    auto subset = deserializeSeriesContainer(serialized, {series[7].first, series[3].first}).ValueOrDie();
+    if (subset.size() != 2 || subset[0].first != series[7].first || subset[1].first != series[3].first) {
+        std::cerr << "Series container. Unexpected subset of series." << std::endl;
+        exit(1);
+    }
+    compareTwoBatches(series[7].second, subset[0].second, 2);
+    compareTwoBatches(series[3].second, subset[1].second, 2);
+    if (deserializeSeriesContainer(serialized, {1}).ok()) {
+        std::cerr << "Series container. Absent series is decoded." << std::endl;
+        exit(1);
+    }
+
+    // Truncated directory is reported as an error.
+    for (int64_t cut : {int64_t(1), int64_t(SeriesInfo::SERIALIZED_SIZE), serialized->size() / 2}) {
+        auto truncated = arrow::SliceBuffer(serialized, 0, serialized->size() - cut);
+        if (readSeriesDirectory(toStringView(truncated)).ok() || deserializeSeriesContainer(truncated).ok()) {
+            std::cerr << "Series container. Container truncated by " << cut << " bytes is read." << std::endl;
+            exit(1);
+        }
+    }
+}
+
+void testTimeSeriesStore() {
+    // Series of points every 10 s over 5 hours (3 windows) appended from several threads.
+    const uint64_t start = 1700000000;
+    const size_t threads_number = 4, series_per_thread = 50, points = 5 * 360;
+    auto value_of = [](uint64_t id, size_t i) {
+        return id % 3 == 0 ? id : id * 1000 + i * (i % 5);
+    };
+    TimeSeriesStore store;
+    std::vector<std::thread> threads;
+    for (size_t k = 0; k < threads_number; k++) {
+        threads.emplace_back([&, k] {
+            for (size_t i = 0; i < points; i++) {
+                for (uint64_t id = k * series_per_thread; id < (k + 1) * series_per_thread; id++) {
+                    store.append(id, start + i * 10, value_of(id, i));
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    if (store.append(0, start, 0)) {
+        std::cerr << "Time series store. Out of order point is appended." << std::endl;
+        exit(1);
+    }
+
+    auto check = [&](uint64_t id, uint64_t from, uint64_t to) {
+        std::vector<uint64_t> ts, vs;
+        size_t n = store.query(id, from, to, ts, vs);
+        size_t expected = 0;
+        for (size_t i = 0; i < points; i++) {
+            uint64_t t = start + i * 10;
+            if (t < from || t > to) {
+                continue;
+            }
+            if (expected >= n || ts[expected] != t || vs[expected] != value_of(id, i)) {
+                std::cerr << "Time series store. Points not equal for series " << id << "." << std::endl;
+                exit(1);
+            }
+            expected++;
+        }
+        if (n != expected || ts.size() != n) {
+            std::cerr << "Time series store. Expected " << expected << " points, got " << n << "." << std::endl;
+            exit(1);
+        }
+    };
+    for (uint64_t id: {uint64_t(0), uint64_t(1), threads_number * series_per_thread - 1}) {
+        check(id, 0, UINT64_MAX);
+        check(id, start + 3 * 3600, start + 3 * 3600 + 600);
+    }
+    store.sealBefore(start + 8 * 3600);
+    check(7, 0, UINT64_MAX);
+
+    auto stats = store.stats();
+    if (stats.series != threads_number * series_per_thread || stats.points != stats.series * points
+        || stats.bookkeeping_bytes == 0) {
+        std::cerr << "Time series store. Unexpected stats." << std::endl;
+        exit(1);
+    }
+    // About 1.4 bytes per point as in the Gorilla paper.
+    double bytes_per_point = static_cast<double>(stats.bytes) / static_cast<double>(stats.points);
+    if (bytes_per_point > 1.5) {
+        std::cerr << "Time series store. Expected about 1.4 bytes per point, got " << bytes_per_point << "."
+                  << std::endl;
+        exit(1);
+    }
+}
+
+void testFormatVersions() {
+    // Empty series and series starting with the value reserved as the end marker of Gorilla values.
+    for (size_t n : {size_t(0), size_t(1), size_t(1000)}) {
+        auto ts_vec = getTestDataVecTs(n);
+        auto vs_vec = getTestDataVecValues<uint64_t>(n);
+        if (n > 0) {
+            vs_vec[0] = UINT64_MAX;
+        }
+        auto batch_ts = getTestDataBatchTs(ts_vec).ValueOrDie();
+        auto batch_vs = getTestDataBatchVs(vs_vec).ValueOrDie();
+        auto batch_pairs = getTestDataBatchPairs(batch_ts, batch_vs);
+
+        for (auto version : {FormatVersion::END_MARKER, FormatVersion::COUNTED}) {
+            // Only the counted format may store the reserved value.
+            bool reserved = n > 0 && version == FormatVersion::END_MARKER;
+            auto ts_serialized = serializeSingleColumnBatch(batch_ts, ValuesCodec::AUTO, version).ValueOrDie();
+            compareTwoBatches(batch_ts, deserializeSingleColumnBatch(ts_serialized).ValueOrDie(), 1);
+            for (auto codec : {ValuesCodec::GORILLA, ValuesCodec::CHIMP, ValuesCodec::CHIMP128, ValuesCodec::INTEGER}) {
+                if (reserved && codec == ValuesCodec::GORILLA) {
+                    continue;
+                }
+                auto vs_serialized = serializeSingleColumnBatch(batch_vs, codec, version).ValueOrDie();
+                compareTwoBatches(batch_vs, deserializeSingleColumnBatch(vs_serialized).ValueOrDie(), 1);
+            }
+            if (reserved) {
+                continue;
+            }
+            for (auto layout : {PairsLayout::INTERLEAVED, PairsLayout::SPLIT}) {
+                auto pairs_serialized = serializePairsBatch(batch_pairs, layout, version).ValueOrDie();
+                compareTwoBatches(batch_pairs, deserializePairsBatch(pairs_serialized, layout).ValueOrDie(), 2);
+            }
+        }
+    }
+
+    // Zeros read past the end of truncated data must not decode as an endless series.
+    auto batch_ts = getTestDataBatchTs(getTestDataVecTs(1000)).ValueOrDie();
+    auto batch_vs = getTestDataBatchVs(getTestDataVecValues<uint64_t>(1000)).ValueOrDie();
+    auto ts_serialized = serializeSingleColumnBatch(batch_ts, ValuesCodec::AUTO, FormatVersion::END_MARKER).ValueOrDie();
+    auto pairs_serialized = serializePairsBatch(getTestDataBatchPairs(batch_ts, batch_vs), PairsLayout::INTERLEAVED,
+                                                FormatVersion::END_MARKER).ValueOrDie();
+    ts_serialized.resize(ts_serialized.size() - 8);
+    pairs_serialized.resize(pairs_serialized.size() - 8);
+    if (deserializeSingleColumnBatch(ts_serialized).ok() || deserializePairsBatch(pairs_serialized).ok()
+        || buildPairsCheckpointIndex(pairs_serialized).ok()) {
+        std::cerr << "Format versions. Series without the end marker is deserialized." << std::endl;
+        exit(1);
+    }
+}
+
+void testTimestampUnits() {
+    // Same 10 s series (with a rare 1 s jitter) in every unit compresses to the same size.
+    size_t seconds_size = 0;
+    for (auto unit : {arrow::TimeUnit::SECOND, arrow::TimeUnit::MILLI, arrow::TimeUnit::MICRO, arrow::TimeUnit::NANO}) {
+        auto type = arrow::timestamp(unit);
+        auto units = static_cast<int64_t>(unitsPerSecond(unit));
+        std::vector<int64_t> ts_vec;
+        for (int64_t i = 0; i < static_cast<int64_t>(10 * DEFAULT_TEST_DATA_LEN); i++) {
+            ts_vec.push_back((1700000000 + i * 10 + (i % 100 == 0)) * units + 7);
+        }
+        arrow::TimestampBuilder builder(type, arrow::default_memory_pool());
+        if (!builder.AppendValues(ts_vec).ok()) {
+            std::cerr << "Timestamp units. Unable to build the timestamps column." << std::endl;
+            exit(1);
+        }
+        auto array = builder.Finish().ValueOrDie();
+        auto batch = arrow::RecordBatch::Make(arrow::schema({arrow::field("Time", type)}), array->length(), {array});
+
+        auto serialized_batch = serializeSingleColumnBatchToBuffer(batch).ValueOrDie();
+        auto batch_deserialized = deserializeSingleColumnBatch(serialized_batch).ValueOrDie();
+        compareTwoBatches(batch, batch_deserialized, 1);
+
+        auto payload_size = parseSerializedBatch(toStringView(serialized_batch)).ValueOrDie().payload.size();
+        if (unit == arrow::TimeUnit::SECOND) {
+            seconds_size = payload_size;
+        } else if (payload_size != seconds_size) {
+            std::cerr << "Timestamp units. " << type->ToString() << " payload is " << payload_size
+                      << " bytes instead of " << seconds_size << "." << std::endl;
+            exit(1);
+        }
+    }
+}
+
 // Prerequisites:
 // Install arrow using package manager or build from source.
 // `sudo apt install -y -V libarrow-dev`
@@ -141,5 +880,22 @@ void testCompressDecompressPairs() {
 // Average compression value is ~0.7
 int main() {
     testCompressDecompressPairs();
+    testBulkDecodePairs();
+    testNarrowValuesCodec();
+    testIntegerCodec();
+    testIntegerKernels();
+    testBlocksDecodeRange();
+    testBlocksAggregates();
+    testAdaptiveBlocks();
+    testRegularBlocks();
+    testTimestampUnits();
+    testFormatVersions();
+    testTimeSeriesStore();
+    testAppendToSerialized();
+    testOpenPairsStream();
+    testPairsCheckpointIndex();
+    testSeriesContainer();
     testDeserializationScenarioWithoutKnownSchema<uint64_t>();
+    testDeserializationScenarioWithoutKnownSchema<uint32_t>();
+    testDeserializationScenarioWithoutKnownSchema<double>();
 }
\ No newline at end of file